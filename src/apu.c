@@ -1,14 +1,631 @@
 #include "./apu.h"
+#include "./cpu_bus.h"
 
-void create_apu(apu_t *apu, interrupt_t *interrupt) {
-    apu->interrupt = interrupt;
+static const unsigned char APU_LENGTHS[32] = {
+    10, 254, 20, 2,  40, 4,  80, 6,  160, 8,  60, 10, 14, 12, 26, 14,
+    12, 16,  24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30,
+};
+
+static const unsigned char APU_DUTY_CYCLES[4][8] = {
+    {0, 1, 0, 0, 0, 0, 0, 0},
+    {0, 1, 1, 0, 0, 0, 0, 0},
+    {0, 1, 1, 1, 1, 0, 0, 0},
+    {1, 0, 0, 1, 1, 1, 1, 1},
+};
+
+static const unsigned char APU_TRIANGLE_SEQUENCE[32] = {
+    15, 14, 13, 12, 11, 10, 9,  8,  7,  6,  5,  4,  3,  2,  1,  0,
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15,
+};
+
+// Noise and DMC timer periods in CPU cycles (NTSC)
+static const unsigned short APU_NOISE_PERIODS[16] = {
+    4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068,
+};
+
+static const unsigned short APU_DMC_PERIODS[16] = {
+    428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54,
+};
+
+void update_irq_apu(apu_t *apu) {
+    set_irq_interrupt(apu->interrupt,
+                      apu->frame_interrupt || apu->dmc.interrupt);
+}
+
+unsigned long advance_timer_apu(unsigned short *timer,
+                                unsigned reload,
+                                unsigned long clocks) {
+    // Timers count down and reload after reaching zero, returns the number of
+    // reloads that happened within the clocks
+    if (clocks <= *timer) {
+        *timer -= clocks;
+        return 0;
+    }
+    clocks -= *timer + 1;
+    *timer = reload - clocks % (reload + 1);
+    return 1 + clocks / (reload + 1);
+}
+
+unsigned char get_volume_apu(apu_envelope_t *envelope) {
+    return envelope->constant ? envelope->volume : envelope->decay;
+}
+
+unsigned short get_sweep_target_apu(apu_t *apu, unsigned channel) {
+    apu_pulse_t *pulse = &apu->pulse[channel];
+    unsigned short change = pulse->period >> pulse->sweep_shift;
+    if (!pulse->sweep_negate) {
+        return pulse->period + change;
+    }
+
+    // Pulse 1 negates with one's complement, pulse 2 with two's complement
+    return pulse->period - change - (channel == 0);
+}
+
+bool is_triangle_active_apu(apu_t *apu) {
+    // Ultrasonic periods are held instead of popping at the Nyquist rate
+    apu_triangle_t *triangle = &apu->triangle;
+    return triangle->length && triangle->linear && triangle->period >= 2;
+}
+
+bool is_dmc_active_apu(apu_t *apu) {
+    apu_dmc_t *dmc = &apu->dmc;
+    return !dmc->silence || dmc->sample_full || dmc->remaining;
+}
+
+unsigned get_frame_step_apu(apu_t *apu) {
+    if (apu->frame_cycles < APU_FRAME_STEP_1) {
+        return APU_FRAME_STEP_1;
+    } else if (apu->frame_cycles < APU_FRAME_STEP_2) {
+        return APU_FRAME_STEP_2;
+    } else if (apu->frame_cycles < APU_FRAME_STEP_3) {
+        return APU_FRAME_STEP_3;
+    } else if (apu->frame_cycles < APU_FRAME_STEP_4) {
+        return APU_FRAME_STEP_4;
+    }
+    return APU_FRAME_STEP_5;
+}
+
+unsigned long get_wait_apu(apu_t *apu) {
+    // Silent channels keep counting but never need to stop the batch
+    unsigned long wait = (APU_FLUSH_CYCLES - apu->time + 1) / 2;
+    wait = min(wait, get_frame_step_apu(apu) - apu->frame_cycles);
+    for (unsigned i = 0; i < 2; i++) {
+        if (!apu->pulse[i].muted) {
+            wait = min(wait, apu->pulse[i].timer + 1ul);
+        }
+    }
+    if (is_triangle_active_apu(apu)) {
+        wait = min(wait, (apu->triangle.timer + 2ul) / 2);
+    }
+    if (apu->noise.length) {
+        wait = min(wait, apu->noise.timer + 1ul);
+    }
+    if (is_dmc_active_apu(apu)) {
+        wait = min(wait, apu->dmc.timer + 1ul);
+    }
+    return wait;
+}
+
+void update_pulse_output_apu(apu_t *apu, unsigned channel) {
+    apu_pulse_t *pulse = &apu->pulse[channel];
+    bool high = APU_DUTY_CYCLES[pulse->duty][pulse->step];
+    unsigned char output =
+        high && !pulse->muted ? get_volume_apu(&pulse->envelope) : 0;
+    apu->dirty |= output != pulse->output;
+    pulse->output = output;
+}
+
+void update_noise_output_apu(apu_t *apu) {
+    apu_noise_t *noise = &apu->noise;
+    unsigned char output = noise->length && !(noise->shift & 1)
+                               ? get_volume_apu(&noise->envelope)
+                               : 0;
+    apu->dirty |= output != noise->output;
+    noise->output = output;
+}
+
+void refresh_apu(apu_t *apu) {
+    // Envelopes, counters, sweeps and registers only change between batches,
+    // so the silencing conditions are evaluated here
+    for (unsigned i = 0; i < 2; i++) {
+        apu_pulse_t *pulse = &apu->pulse[i];
+        pulse->muted = !pulse->length || pulse->period < 8 ||
+                       get_sweep_target_apu(apu, i) > 0x7ff;
+        update_pulse_output_apu(apu, i);
+    }
+    update_noise_output_apu(apu);
+    apu->dirty = true;
+}
+
+void create_apu(apu_t *apu, mapper_t *mapper, interrupt_t *interrupt) {
+    memset(apu->pulse, 0, sizeof(apu->pulse));
+    memset(&apu->triangle, 0, sizeof(apu->triangle));
+    memset(&apu->noise, 0, sizeof(apu->noise));
+    memset(&apu->dmc, 0, sizeof(apu->dmc));
+    apu->noise.shift = 1;
+    apu->noise.period = APU_NOISE_PERIODS[0] / 2;
+    apu->dmc.period = APU_DMC_PERIODS[0] / 2;
+    apu->dmc.sample_address = 0xc000;
+    apu->dmc.sample_length = 1;
+    apu->dmc.bits = 8;
+    apu->dmc.silence = true;
+
+    apu->status = 0;
+    apu->frame_counter = 0;
+    apu->frame_cycles = 0;
+    apu->frame_interrupt = false;
+    apu->amplitude = 0;
+    apu->dirty = false;
+    apu->time = 0;
+    apu->pending = 0;
     apu->cycles = 0;
-    create_buffer(&apu->buffer, AUDIO_BUFFER_SIZE);
+
+    // Nonlinear mixer approximation from the NESdev wiki
+    apu->pulse_table[0] = 0;
+    for (unsigned i = 1; i < 31; i++) {
+        apu->pulse_table[i] = 95.52 / (8128.0 / i + 100);
+    }
+    apu->tnd_table[0] = 0;
+    for (unsigned i = 1; i < 203; i++) {
+        apu->tnd_table[i] = 163.67 / (24329.0 / i + 100);
+    }
+
+    create_blip(&apu->blip,
+                APU_CLOCK_RATE,
+                APU_SAMPLE_RATE,
+                get_blip_size_apu(APU_SAMPLE_RATE));
+    apu->highpass_input = 0;
+    apu->highpass_output = 0;
+    create_buffer(&apu->buffer, get_buffer_size_apu(APU_SAMPLE_RATE));
+    apu->sample_rate = APU_SAMPLE_RATE;
+    apu->rate_control = false;
+    apu->mapper = mapper;
+    apu->interrupt = interrupt;
+
+    refresh_apu(apu);
+    apu->wait = get_wait_apu(apu);
+}
+
+void destroy_apu(apu_t *apu) {
+    destroy_blip(&apu->blip);
+    destroy_buffer(&apu->buffer);
+}
+
+void mix_apu(apu_t *apu, unsigned long time) {
+    float amplitude =
+        apu->pulse_table[apu->pulse[0].output + apu->pulse[1].output] +
+        apu->tnd_table[3 * apu->triangle.output + 2 * apu->noise.output +
+                       apu->dmc.output];
+
+    // Only level changes reach the synthesis buffer
+    if (amplitude != apu->amplitude) {
+        add_delta_blip(&apu->blip, time, amplitude - apu->amplitude);
+        apu->amplitude = amplitude;
+    }
+    apu->dirty = false;
+}
+
+void clock_envelope_apu(apu_envelope_t *envelope) {
+    if (envelope->start) {
+        envelope->start = false;
+        envelope->decay = 15;
+        envelope->divider = envelope->volume;
+    } else if (envelope->divider == 0) {
+        envelope->divider = envelope->volume;
+        if (envelope->decay > 0) {
+            envelope->decay--;
+        } else if (envelope->loop) {
+            envelope->decay = 15;
+        }
+    } else {
+        envelope->divider--;
+    }
 }
 
-void destroy_apu(apu_t *apu) { destroy_buffer(&apu->buffer); }
+void clock_sweep_apu(apu_t *apu, unsigned channel) {
+    apu_pulse_t *pulse = &apu->pulse[channel];
+    unsigned short target = get_sweep_target_apu(apu, channel);
+    if (pulse->sweep_divider == 0 && pulse->sweep_enabled &&
+        pulse->sweep_shift > 0 && pulse->period >= 8 && target <= 0x7ff) {
+        pulse->period = target;
+    }
+    if (pulse->sweep_divider == 0 || pulse->sweep_reload) {
+        pulse->sweep_divider = pulse->sweep_period;
+        pulse->sweep_reload = false;
+    } else {
+        pulse->sweep_divider--;
+    }
+}
+
+void clock_quarter_frame_apu(apu_t *apu) {
+    clock_envelope_apu(&apu->pulse[0].envelope);
+    clock_envelope_apu(&apu->pulse[1].envelope);
+    clock_envelope_apu(&apu->noise.envelope);
+
+    apu_triangle_t *triangle = &apu->triangle;
+    if (triangle->linear_reload) {
+        triangle->linear = triangle->linear_period;
+    } else if (triangle->linear > 0) {
+        triangle->linear--;
+    }
+    if (!triangle->control) {
+        triangle->linear_reload = false;
+    }
+}
+
+void clock_half_frame_apu(apu_t *apu) {
+    for (unsigned i = 0; i < 2; i++) {
+        apu_pulse_t *pulse = &apu->pulse[i];
+        if (pulse->length && !pulse->envelope.loop) {
+            pulse->length--;
+        }
+        clock_sweep_apu(apu, i);
+    }
+    if (apu->triangle.length && !apu->triangle.control) {
+        apu->triangle.length--;
+    }
+    if (apu->noise.length && !apu->noise.envelope.loop) {
+        apu->noise.length--;
+    }
+}
+
+void clock_frame_counter_apu(apu_t *apu) {
+    bool five_step = apu->frame_counter & APU_FRAME_FIVE_STEP;
+    switch (apu->frame_cycles) {
+    case APU_FRAME_STEP_1:
+    case APU_FRAME_STEP_3:
+        clock_quarter_frame_apu(apu);
+        break;
+    case APU_FRAME_STEP_2:
+        clock_quarter_frame_apu(apu);
+        clock_half_frame_apu(apu);
+        break;
+    case APU_FRAME_STEP_4:
+        if (five_step) {
+            return;
+        }
+        clock_quarter_frame_apu(apu);
+        clock_half_frame_apu(apu);
+        if (!(apu->frame_counter & APU_FRAME_IRQ_INHIBIT)) {
+            apu->frame_interrupt = true;
+            update_irq_apu(apu);
+        }
+        apu->frame_cycles = 0;
+        break;
+    case APU_FRAME_STEP_5:
+        clock_quarter_frame_apu(apu);
+        clock_half_frame_apu(apu);
+        apu->frame_cycles = 0;
+        break;
+    default:
+        return;
+    }
+    refresh_apu(apu);
+}
+
+void fill_dmc_apu(apu_t *apu) {
+    apu_dmc_t *dmc = &apu->dmc;
+    if (dmc->sample_full || !dmc->remaining) {
+        return;
+    }
+
+    // Memory reader refills the sample buffer as soon as it empties
+    dmc->sample = read_cpu_mapper(apu->mapper, dmc->address);
+    dmc->sample_full = true;
+    dmc->address = dmc->address == 0xffff ? 0x8000 : dmc->address + 1;
+    if (--dmc->remaining == 0) {
+        if (dmc->loop) {
+            dmc->address = dmc->sample_address;
+            dmc->remaining = dmc->sample_length;
+        } else if (dmc->irq_enabled) {
+            dmc->interrupt = true;
+            update_irq_apu(apu);
+        }
+    }
+}
+
+void clock_dmc_apu(apu_t *apu) {
+    // Output unit slews the level by 2 for each sample bit
+    apu_dmc_t *dmc = &apu->dmc;
+    if (!dmc->silence) {
+        if ((dmc->shift & 1) && dmc->output <= 125) {
+            dmc->output += 2;
+            apu->dirty = true;
+        } else if (!(dmc->shift & 1) && dmc->output >= 2) {
+            dmc->output -= 2;
+            apu->dirty = true;
+        }
+    }
+    dmc->shift >>= 1;
+    if (--dmc->bits == 0) {
+        dmc->bits = 8;
+        dmc->silence = !dmc->sample_full;
+        dmc->shift = dmc->sample;
+        dmc->sample_full = false;
+        fill_dmc_apu(apu);
+    }
+}
+
+unsigned get_blip_size_apu(unsigned sample_rate) {
+    double samples = sample_rate * (1 + APU_RATE_CONTROL) * APU_FLUSH_CYCLES /
+                     APU_CLOCK_RATE;
+    return ceil(samples) + APU_BLIP_MARGIN;
+}
+
+unsigned get_buffer_size_apu(unsigned sample_rate) {
+    unsigned samples = get_blip_size_apu(sample_rate) - APU_BLIP_MARGIN;
+    unsigned size = 1;
+    while (size < samples * APU_BUFFER_FLUSHES * sizeof(float)) {
+        size <<= 1;
+    }
+    return size;
+}
+
+void set_rate_apu(apu_t *apu, unsigned sample_rate, bool rate_control) {
+    apu->sample_rate = sample_rate;
+    apu->rate_control = rate_control;
+    resize_blip(&apu->blip, get_blip_size_apu(sample_rate));
+
+    // Buffered samples are dropped, there is no consumer yet to miss them
+    unsigned size = get_buffer_size_apu(sample_rate);
+    if (size > get_capacity_buffer(&apu->buffer)) {
+        destroy_buffer(&apu->buffer);
+        create_buffer(&apu->buffer, size);
+    }
+    set_rate_blip(&apu->blip, APU_CLOCK_RATE, sample_rate);
+}
+
+void flush_apu(apu_t *apu) {
+    float samples[0x100];
+    end_frame_blip(&apu->blip, apu->time);
+    apu->time = 0;
+
+    unsigned count;
+    while ((count = read_samples_blip(&apu->blip, samples, 0x100))) {
+        for (unsigned i = 0; i < count; i++) {
+            float input = samples[i];
+            apu->highpass_output = APU_HIGHPASS * (apu->highpass_output +
+                                                   input - apu->highpass_input);
+            apu->highpass_input = input;
+            samples[i] = apu->highpass_output;
+        }
+        write_buffer(&apu->buffer,
+                     (unsigned char *)samples,
+                     count * sizeof(float));
+    }
+
+    // Produce more samples while the buffer is below half full and fewer
+    // above, the deviation being too small to hear as a pitch change
+    if (apu->rate_control) {
+        double fill = get_fill_buffer(&apu->buffer);
+        double ratio = 1 + APU_RATE_CONTROL * (1 - 2 * fill);
+        set_rate_blip(&apu->blip, APU_CLOCK_RATE, apu->sample_rate * ratio);
+    }
+}
 
 void update_apu(apu_t *apu) {
-    // TODO: Implement this
     apu->cycles++;
+    if (++apu->pending >= apu->wait) {
+        run_apu(apu);
+    }
+}
+
+void run_apu(apu_t *apu) {
+    // Frame steps are matched exactly, so an empty batch must not repeat one
+    if (!apu->pending) {
+        return;
+    }
+    unsigned long cycles = apu->pending;
+    unsigned long time = apu->time;
+    apu->pending = 0;
+    apu->time += 2 * cycles;
+
+    // The triangle timer runs at the CPU rate and may step mid-batch
+    apu_triangle_t *triangle = &apu->triangle;
+    unsigned long offset = triangle->timer + 1;
+    bool active = is_triangle_active_apu(apu);
+    unsigned long steps =
+        advance_timer_apu(&triangle->timer, triangle->period, 2 * cycles);
+    if (steps && active) {
+        triangle->step = (triangle->step + steps) % 32;
+        triangle->output = APU_TRIANGLE_SEQUENCE[triangle->step];
+        mix_apu(apu, time + offset);
+    }
+
+    for (unsigned i = 0; i < 2; i++) {
+        apu_pulse_t *pulse = &apu->pulse[i];
+        steps = advance_timer_apu(&pulse->timer, pulse->period, cycles);
+        if (steps) {
+            pulse->step = (pulse->step + steps) % 8;
+            update_pulse_output_apu(apu, i);
+        }
+    }
+
+    apu_noise_t *noise = &apu->noise;
+    steps = advance_timer_apu(&noise->timer, noise->period - 1, cycles);
+    for (unsigned long i = 0; i < steps; i++) {
+        unsigned tap = noise->mode ? 6 : 1;
+        unsigned feedback = (noise->shift ^ (noise->shift >> tap)) & 1;
+        noise->shift = (noise->shift >> 1) | (feedback << 14);
+    }
+    if (steps) {
+        update_noise_output_apu(apu);
+    }
+
+    apu_dmc_t *dmc = &apu->dmc;
+    steps = advance_timer_apu(&dmc->timer, dmc->period - 1, cycles);
+    for (unsigned long i = 0; i < steps; i++) {
+        clock_dmc_apu(apu);
+    }
+
+    apu->frame_cycles += cycles;
+    clock_frame_counter_apu(apu);
+    if (apu->dirty) {
+        mix_apu(apu, apu->time);
+    }
+    if (apu->time >= APU_FLUSH_CYCLES) {
+        flush_apu(apu);
+    }
+    apu->wait = get_wait_apu(apu);
+}
+
+unsigned char read_status_apu(apu_t *apu) {
+    run_apu(apu);
+    unsigned char status = 0;
+    status |= apu->pulse[0].length ? APU_STATUS_PULSE1 : 0;
+    status |= apu->pulse[1].length ? APU_STATUS_PULSE2 : 0;
+    status |= apu->triangle.length ? APU_STATUS_TRIANGLE : 0;
+    status |= apu->noise.length ? APU_STATUS_NOISE : 0;
+    status |= apu->dmc.remaining ? APU_STATUS_DMC : 0;
+    status |= apu->frame_interrupt ? APU_STATUS_FRAME_IRQ : 0;
+    status |= apu->dmc.interrupt ? APU_STATUS_DMC_IRQ : 0;
+
+    apu->frame_interrupt = false;
+    update_irq_apu(apu);
+    return status;
+}
+
+void write_pulse_apu(apu_t *apu,
+                     unsigned channel,
+                     unsigned reg,
+                     unsigned char value) {
+    apu_pulse_t *pulse = &apu->pulse[channel];
+    switch (reg) {
+    case 0:
+        pulse->duty = value >> 6;
+        pulse->envelope.loop = value & 0x20;
+        pulse->envelope.constant = value & 0x10;
+        pulse->envelope.volume = value & 0x0f;
+        break;
+    case 1:
+        pulse->sweep_enabled = value & 0x80;
+        pulse->sweep_period = (value >> 4) & 0x07;
+        pulse->sweep_negate = value & 0x08;
+        pulse->sweep_shift = value & 0x07;
+        pulse->sweep_reload = true;
+        break;
+    case 2:
+        pulse->period = (pulse->period & 0x700) | value;
+        break;
+    case 3:
+        pulse->period = (pulse->period & 0xff) | ((value & 0x07) << 8);
+        if (apu->status & (APU_STATUS_PULSE1 << channel)) {
+            pulse->length = APU_LENGTHS[value >> 3];
+        }
+        pulse->envelope.start = true;
+        pulse->step = 0;
+        break;
+    }
+}
+
+void write_status_apu(apu_t *apu, unsigned char value) {
+    apu->status = value;
+    if (!(value & APU_STATUS_PULSE1)) {
+        apu->pulse[0].length = 0;
+    }
+    if (!(value & APU_STATUS_PULSE2)) {
+        apu->pulse[1].length = 0;
+    }
+    if (!(value & APU_STATUS_TRIANGLE)) {
+        apu->triangle.length = 0;
+    }
+    if (!(value & APU_STATUS_NOISE)) {
+        apu->noise.length = 0;
+    }
+
+    // Enabling the DMC restarts the sample only once it has finished
+    apu_dmc_t *dmc = &apu->dmc;
+    if (!(value & APU_STATUS_DMC)) {
+        dmc->remaining = 0;
+    } else if (dmc->remaining == 0) {
+        dmc->address = dmc->sample_address;
+        dmc->remaining = dmc->sample_length;
+        fill_dmc_apu(apu);
+    }
+    dmc->interrupt = false;
+    update_irq_apu(apu);
+}
+
+void write_register_apu(apu_t *apu, address_t address, unsigned char value) {
+    apu_triangle_t *triangle = &apu->triangle;
+    apu_noise_t *noise = &apu->noise;
+    apu_dmc_t *dmc = &apu->dmc;
+    run_apu(apu);
+    switch (address) {
+    case APU_REG_PULSE1_0:
+    case APU_REG_PULSE1_1:
+    case APU_REG_PULSE1_2:
+    case APU_REG_PULSE1_3:
+    case APU_REG_PULSE2_0:
+    case APU_REG_PULSE2_1:
+    case APU_REG_PULSE2_2:
+    case APU_REG_PULSE2_3: {
+        unsigned offset = address - APU_REG_PULSE1_0;
+        write_pulse_apu(apu, offset / 4, offset % 4, value);
+    } break;
+    case APU_REG_TRIANGLE_0:
+        triangle->control = value & 0x80;
+        triangle->linear_period = value & 0x7f;
+        break;
+    case APU_REG_TRIANGLE_2:
+        triangle->period = (triangle->period & 0x700) | value;
+        break;
+    case APU_REG_TRIANGLE_3:
+        triangle->period = (triangle->period & 0xff) | ((value & 0x07) << 8);
+        if (apu->status & APU_STATUS_TRIANGLE) {
+            triangle->length = APU_LENGTHS[value >> 3];
+        }
+        triangle->linear_reload = true;
+        break;
+    case APU_REG_NOISE_0:
+        noise->envelope.loop = value & 0x20;
+        noise->envelope.constant = value & 0x10;
+        noise->envelope.volume = value & 0x0f;
+        break;
+    case APU_REG_NOISE_2:
+        noise->mode = value & 0x80;
+        noise->period = APU_NOISE_PERIODS[value & 0x0f] / 2;
+        break;
+    case APU_REG_NOISE_3:
+        if (apu->status & APU_STATUS_NOISE) {
+            noise->length = APU_LENGTHS[value >> 3];
+        }
+        noise->envelope.start = true;
+        break;
+    case APU_REG_DMC_0:
+        dmc->irq_enabled = value & 0x80;
+        dmc->loop = value & 0x40;
+        dmc->period = APU_DMC_PERIODS[value & 0x0f] / 2;
+        if (!dmc->irq_enabled) {
+            dmc->interrupt = false;
+            update_irq_apu(apu);
+        }
+        break;
+    case APU_REG_DMC_1:
+        dmc->output = value & 0x7f;
+        break;
+    case APU_REG_DMC_2:
+        dmc->sample_address = 0xc000 | (value << 6);
+        break;
+    case APU_REG_DMC_3:
+        dmc->sample_length = (value << 4) | 1;
+        break;
+    case APU_REG_STATUS:
+        write_status_apu(apu, value);
+        break;
+    case APU_REG_FRAME_COUNTER:
+        apu->frame_counter = value;
+        apu->frame_cycles = 0;
+        if (value & APU_FRAME_IRQ_INHIBIT) {
+            apu->frame_interrupt = false;
+            update_irq_apu(apu);
+        }
+        if (value & APU_FRAME_FIVE_STEP) {
+            clock_quarter_frame_apu(apu);
+            clock_half_frame_apu(apu);
+        }
+        break;
+    }
+    refresh_apu(apu);
+    apu->wait = get_wait_apu(apu);
 }
\ No newline at end of file
@@ -1,46 +1,297 @@
 #ifndef APU_H
 #define APU_H
 
+#include "./blip.h"
 #include "./buffer.h"
 #include "./interrupt.h"
+#include "./mapper.h"
 
-#define AUDIO_BUFFER_SIZE 0x400
+// Output ring of 32-bit float samples holding at least this many flushes,
+// about 90 ms at 44.1 kHz
+#define APU_BUFFER_FLUSHES 4
+
+// NTSC CPU clock and default host sample rate
+#define APU_CLOCK_RATE  1789773
+#define APU_SAMPLE_RATE 44100
+
+// CPU cycles synthesized between flushes of the band-limited buffer, one NTSC
+// frame so that filtering and rate control run once per frame
+#define APU_FLUSH_CYCLES 29780
+
+// Band-limited buffer slack beyond a flush worth of samples, covering the
+// fractional offset carried between flushes and the kernel tail
+#define APU_BLIP_MARGIN 0x20
+
+// Largest output rate deviation applied by dynamic rate control
+#define APU_RATE_CONTROL 0.005
+
+// Frame counter steps in APU cycles
+#define APU_FRAME_STEP_1 3728
+#define APU_FRAME_STEP_2 7456
+#define APU_FRAME_STEP_3 11185
+#define APU_FRAME_STEP_4 14914
+#define APU_FRAME_STEP_5 18640
+
+// Frame counter register flags
+#define APU_FRAME_IRQ_INHIBIT (1 << 6)
+#define APU_FRAME_FIVE_STEP   (1 << 7)
+
+// Status register flags
+#define APU_STATUS_PULSE1    (1 << 0)
+#define APU_STATUS_PULSE2    (1 << 1)
+#define APU_STATUS_TRIANGLE  (1 << 2)
+#define APU_STATUS_NOISE     (1 << 3)
+#define APU_STATUS_DMC       (1 << 4)
+#define APU_STATUS_FRAME_IRQ (1 << 6)
+#define APU_STATUS_DMC_IRQ   (1 << 7)
+
+// One-pole high-pass coefficient removing DC around 90 Hz
+#define APU_HIGHPASS 0.987f
+
+/**
+ * @brief Volume envelope shared by the pulse and noise channels.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Restart the envelope on the next quarter frame.
+     *
+     */
+    bool start;
+
+    /**
+     * @brief Loop the decay, also halts the length counter.
+     *
+     */
+    bool loop;
+
+    /**
+     * @brief Use the constant volume instead of the decay level.
+     *
+     */
+    bool constant;
+
+    /**
+     * @brief Constant volume and divider period.
+     *
+     */
+    unsigned char volume;
+
+    /**
+     * @brief Divider counter.
+     *
+     */
+    unsigned char divider;
+
+    /**
+     * @brief Decay level.
+     *
+     */
+    unsigned char decay;
+} apu_envelope_t;
+
+/**
+ * @brief Pulse (square wave) channel.
+ *
+ */
+typedef struct {
+    apu_envelope_t envelope;
+
+    /**
+     * @brief Duty cycle and position in the 8-step sequence.
+     *
+     */
+    unsigned char duty, step;
+
+    /**
+     * @brief Timer period and counter in APU cycles.
+     *
+     */
+    unsigned short period, timer;
+
+    /**
+     * @brief Length counter.
+     *
+     */
+    unsigned char length;
+
+    /**
+     * @brief Sweep unit settings.
+     *
+     */
+    bool sweep_enabled, sweep_negate, sweep_reload;
+
+    /**
+     * @brief Sweep divider period, shift count and divider counter.
+     *
+     */
+    unsigned char sweep_period, sweep_shift, sweep_divider;
+
+    /**
+     * @brief Silenced by the length counter or the sweep unit.
+     *
+     */
+    bool muted;
+
+    /**
+     * @brief Current output level (0-15).
+     *
+     */
+    unsigned char output;
+} apu_pulse_t;
+
+/**
+ * @brief Triangle channel.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Linear counter control, also halts the length counter.
+     *
+     */
+    bool control;
+
+    /**
+     * @brief Reload the linear counter on the next quarter frame.
+     *
+     */
+    bool linear_reload;
+
+    /**
+     * @brief Linear counter reload value and counter.
+     *
+     */
+    unsigned char linear_period, linear;
+
+    /**
+     * @brief Position in the 32-step sequence.
+     *
+     */
+    unsigned char step;
+
+    /**
+     * @brief Timer period and counter in CPU cycles.
+     *
+     */
+    unsigned short period, timer;
+
+    /**
+     * @brief Length counter.
+     *
+     */
+    unsigned char length;
+
+    /**
+     * @brief Current output level (0-15).
+     *
+     */
+    unsigned char output;
+} apu_triangle_t;
+
+/**
+ * @brief Noise channel.
+ *
+ */
+typedef struct {
+    apu_envelope_t envelope;
+
+    /**
+     * @brief Short mode, feeding back from bit 6 instead of bit 1.
+     *
+     */
+    bool mode;
+
+    /**
+     * @brief 15-bit linear feedback shift register.
+     *
+     */
+    unsigned short shift;
+
+    /**
+     * @brief Timer period and counter in APU cycles.
+     *
+     */
+    unsigned short period, timer;
+
+    /**
+     * @brief Length counter.
+     *
+     */
+    unsigned char length;
+
+    /**
+     * @brief Current output level (0-15).
+     *
+     */
+    unsigned char output;
+} apu_noise_t;
 
 /**
- * @brief APU registers.
+ * @brief Delta modulation channel playing 1-bit samples from memory.
  *
  */
 typedef struct {
     /**
-     * @brief Pulse 1 channel registers.
+     * @brief Raise an IRQ when a sample ends without looping.
+     *
+     */
+    bool irq_enabled;
+
+    /**
+     * @brief Restart the sample when it ends.
+     *
+     */
+    bool loop;
+
+    /**
+     * @brief IRQ flag.
+     *
+     */
+    bool interrupt;
+
+    /**
+     * @brief Timer period and counter in APU cycles.
      *
      */
-    unsigned char pulse1[4];
+    unsigned short period, timer;
 
     /**
-     * @brief Pulse 2 channel registers.
+     * @brief Sample start address and length in bytes.
      *
      */
-    unsigned char pulse2[4];
+    unsigned short sample_address, sample_length;
 
     /**
-     * @brief Triangle channel registers.
+     * @brief Memory reader address and bytes remaining.
      *
      */
-    unsigned char triangle[4];
+    unsigned short address, remaining;
 
     /**
-     * @brief Noise channel registers.
+     * @brief Sample buffer and whether it holds a byte.
      *
      */
-    unsigned char noise[4];
+    unsigned char sample;
+    bool sample_full;
 
     /**
-     * @brief DMC channel registers.
+     * @brief Output unit shift register and bits remaining.
      *
      */
-    unsigned char dmc[4];
-} apu_channel_registers_t;
+    unsigned char shift, bits;
+
+    /**
+     * @brief Output unit is silenced.
+     *
+     */
+    bool silence;
+
+    /**
+     * @brief Current output level (0-127).
+     *
+     */
+    unsigned char output;
+} apu_dmc_t;
 
 /**
  * @brief The Audio Processing Unit is responsible for generating sound.
@@ -48,19 +299,31 @@ typedef struct {
  */
 typedef struct {
     /**
-     * @brief Audio output buffer.
+     * @brief Pulse channels.
      *
      */
-    buffer_t buffer;
+    apu_pulse_t pulse[2];
+
+    /**
+     * @brief Triangle channel.
+     *
+     */
+    apu_triangle_t triangle;
+
+    /**
+     * @brief Noise channel.
+     *
+     */
+    apu_noise_t noise;
 
     /**
-     * @brief Internal channel registers.
+     * @brief DMC channel.
      *
      */
-    apu_channel_registers_t channel_registers;
+    apu_dmc_t dmc;
 
     /**
-     * @brief Status/control register.
+     * @brief Channel enable flags written to the status register.
      *
      */
     unsigned char status;
@@ -71,12 +334,102 @@ typedef struct {
      */
     unsigned char frame_counter;
 
+    /**
+     * @brief APU cycles into the frame counter sequence.
+     *
+     */
+    unsigned frame_cycles;
+
+    /**
+     * @brief Frame counter IRQ flag.
+     *
+     */
+    bool frame_interrupt;
+
+    /**
+     * @brief Mixed output level.
+     *
+     */
+    float amplitude;
+
+    /**
+     * @brief A channel output changed since the last mix.
+     *
+     */
+    bool dirty;
+
+    /**
+     * @brief CPU cycles synthesized since the last flush.
+     *
+     */
+    unsigned long time;
+
+    /**
+     * @brief APU cycles elapsed since the channels were last advanced.
+     *
+     */
+    unsigned long pending;
+
+    /**
+     * @brief APU cycles from the last advance to the next channel event.
+     *
+     */
+    unsigned long wait;
+
     /**
      * @brief Number of cycles.
      *
      */
     unsigned long cycles;
 
+    /**
+     * @brief Nonlinear mixer output for the sum of the pulse levels.
+     *
+     */
+    float pulse_table[31];
+
+    /**
+     * @brief Nonlinear mixer output for 3 * triangle + 2 * noise + DMC.
+     *
+     */
+    float tnd_table[203];
+
+    /**
+     * @brief Band-limited synthesis buffer.
+     *
+     */
+    blip_t blip;
+
+    /**
+     * @brief Previous input and output of the high-pass filter.
+     *
+     */
+    float highpass_input, highpass_output;
+
+    /**
+     * @brief Audio output buffer.
+     *
+     */
+    buffer_t buffer;
+
+    /**
+     * @brief Nominal output sample rate.
+     *
+     */
+    unsigned sample_rate;
+
+    /**
+     * @brief Whether the output rate follows the fill level of the buffer.
+     *
+     */
+    bool rate_control;
+
+    /**
+     * @brief Pointer to the mapper for DMC sample reads.
+     *
+     */
+    mapper_t *mapper;
+
     /**
      * @brief Pointer to the interrupt state.
      *
@@ -88,9 +441,10 @@ typedef struct {
  * @brief Create the APU.
  *
  * @param apu
+ * @param mapper
  * @param interrupt
  */
-void create_apu(apu_t *apu, interrupt_t *interrupt);
+void create_apu(apu_t *apu, mapper_t *mapper, interrupt_t *interrupt);
 
 /**
  * @brief Destroy the APU.
@@ -100,10 +454,71 @@ void create_apu(apu_t *apu, interrupt_t *interrupt);
 void destroy_apu(apu_t *apu);
 
 /**
- * @brief Update the APU.
+ * @brief Get the band-limited buffer capacity needed to hold a flush at the
+ * highest rate rate control can reach.
+ *
+ * @param sample_rate
+ * @return unsigned
+ */
+unsigned get_blip_size_apu(unsigned sample_rate);
+
+/**
+ * @brief Get the output buffer capacity in bytes, the smallest power of two
+ * holding APU_BUFFER_FLUSHES flushes at the highest rate rate control can
+ * reach.
+ *
+ * @param sample_rate
+ * @return unsigned
+ */
+unsigned get_buffer_size_apu(unsigned sample_rate);
+
+/**
+ * @brief Set the output sample rate.
+ *
+ * With rate control, each flush nudges the rate by up to APU_RATE_CONTROL to
+ * steer the output buffer towards half full, so a consumer running on a
+ * separate clock neither starves nor overflows it. The band-limited and output
+ * buffers grow to fit any rate, so a consumer of the output buffer must not
+ * start before this is called.
+ *
+ * @param apu
+ * @param sample_rate
+ * @param rate_control
+ */
+void set_rate_apu(apu_t *apu, unsigned sample_rate, bool rate_control);
+
+/**
+ * @brief Update the APU by one APU cycle (two CPU cycles).
+ *
+ * Cycles are only counted here, the channels are advanced in one batch when
+ * the next timer expiry, frame counter step or buffer flush is reached.
  *
  * @param apu
  */
 void update_apu(apu_t *apu);
 
+/**
+ * @brief Advance the channels by the pending cycles.
+ *
+ * @param apu
+ */
+void run_apu(apu_t *apu);
+
+/**
+ * @brief Read the status register, acknowledging the frame IRQ.
+ *
+ * @param apu
+ * @return unsigned char
+ */
+unsigned char read_status_apu(apu_t *apu);
+
+/**
+ * @brief Write to a memory mapped APU register.
+ *
+ * @param apu
+ * @param address
+ * @param value
+ */
+void write_register_apu(apu_t *apu, address_t address, unsigned char value);
+
 #endif
\ No newline at end of file
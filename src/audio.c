@@ -7,20 +7,27 @@ void create_audio(audio_t *audio, buffer_t *buffer) {
     SDL_zero(desired_spec);
 
     desired_spec.channels = 1;
-    desired_spec.freq = 44100;
+    desired_spec.freq = APU_SAMPLE_RATE;
     desired_spec.format = SDL_AUDIO_F32LSB;
     desired_spec.samples = AUDIO_BUFFER_SIZE;
     desired_spec.userdata = buffer;
     desired_spec.callback = play_callback_audio;
 
-    audio->id = SDL_OpenAudioDevice(NULL, 0, &desired_spec, &audio->spec, 0);
+    // Accept the native device rate, the APU synthesizes at any rate
+    audio->id = SDL_OpenAudioDevice(NULL,
+                                    0,
+                                    &desired_spec,
+                                    &audio->spec,
+                                    SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
     if (!audio->id) {
         fprintf(stderr,
                 "Error: Failed to open audio device (%s)\n",
                 SDL_GetError());
         exit(1);
     }
+}
 
+void play_audio(audio_t *audio) {
     int result = SDL_PlayAudioDevice(audio->id);
     if (result < 0) {
         fprintf(stderr,
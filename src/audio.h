@@ -3,9 +3,11 @@
 
 #include <SDL.h>
 
+#include "./apu.h"
 #include "./buffer.h"
 
-#define AUDIO_BUFFER_SIZE 0x400
+// Device buffer in sample frames, the lock-free ring absorbs the jitter
+#define AUDIO_BUFFER_SIZE 0x200
 
 /**
  * @brief Audio device.
@@ -26,13 +28,20 @@ typedef struct {
 } audio_t;
 
 /**
- * @brief Create the audio device.
+ * @brief Create the audio device, paused until play_audio() is called.
  *
  * @param audio
  * @param buffer
  */
 void create_audio(audio_t *audio, buffer_t *buffer);
 
+/**
+ * @brief Start pulling samples from the buffer.
+ *
+ * @param audio
+ */
+void play_audio(audio_t *audio);
+
 /**
  * @brief Destroy the audio device.
  *
@@ -0,0 +1,222 @@
+#include "./batch.h"
+
+void load_movie_batch(memory_t *movie, const char *path) {
+    movie->buffer = NULL;
+    movie->size = 0;
+    if (strcmp(path, BATCH_NONE) == 0) {
+        return;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Could not open movie \"%s\"\n", path);
+        exit(1);
+    }
+    fseek(file, 0, SEEK_END);
+    unsigned long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size) {
+        *movie = allocate_memory(size);
+        if (fread(movie->buffer, 1, size, file) != size) {
+            fprintf(stderr, "Error: Could not read movie \"%s\"\n", path);
+            exit(1);
+        }
+    }
+    fclose(file);
+}
+
+const rom_t *get_rom_batch(batch_t *batch, const char *path) {
+    for (unsigned i = 0; i < batch->rom_count; i++) {
+        if (strcmp(batch->rom_paths[i], path) == 0) {
+            return &batch->roms[i];
+        }
+    }
+    return NULL;
+}
+
+void load_rom_batch(batch_t *batch, const char *path) {
+    if (get_rom_batch(batch, path)) {
+        return;
+    }
+    unsigned count = batch->rom_count + 1;
+    batch->roms = (rom_t *)realloc(batch->roms, count * sizeof(rom_t));
+    batch->rom_paths = realloc(batch->rom_paths, count * BATCH_PATH_SIZE);
+    if (batch->roms == NULL || batch->rom_paths == NULL) {
+        fprintf(stderr, "Error: Unable to allocate %u ROMs\n", count);
+        exit(1);
+    }
+
+    rom_t *rom = &batch->roms[batch->rom_count];
+    load_rom(rom, path);
+    if (rom->header.type == NES_INVALID) {
+        fprintf(stderr, "Error: Invalid ROM \"%s\"\n", path);
+        exit(1);
+    }
+    strcpy(batch->rom_paths[batch->rom_count], path);
+    batch->rom_count = count;
+}
+
+void load_manifest_batch(batch_t *batch, const char *path) {
+    batch->jobs = NULL;
+    batch->count = 0;
+    batch->roms = NULL;
+    batch->rom_paths = NULL;
+    batch->rom_count = 0;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Could not open manifest \"%s\"\n", path);
+        exit(1);
+    }
+
+    char line[4 * BATCH_PATH_SIZE];
+    unsigned capacity = 0;
+    for (unsigned number = 1; fgets(line, sizeof(line), file); number++) {
+        char rom_path[BATCH_PATH_SIZE];
+        char movie_path[BATCH_PATH_SIZE];
+        char output_path[BATCH_PATH_SIZE];
+        unsigned long frames;
+
+        // Skip blank lines and comments
+        char first[2];
+        if (sscanf(line, "%1s", first) != 1 || first[0] == '#') {
+            continue;
+        }
+        if (sscanf(line,
+                   "%1023s %1023s %lu %1023s",
+                   rom_path,
+                   movie_path,
+                   &frames,
+                   output_path) != 4) {
+            fprintf(stderr, "Error: Invalid manifest line %u\n", number);
+            exit(1);
+        }
+
+        if (batch->count == capacity) {
+            capacity = max(2 * capacity, 16);
+            unsigned long size = capacity * sizeof(batch_job_t);
+            batch->jobs = (batch_job_t *)realloc(batch->jobs, size);
+            if (batch->jobs == NULL) {
+                fprintf(stderr,
+                        "Error: Unable to allocate %u jobs\n",
+                        capacity);
+                exit(1);
+            }
+        }
+        batch_job_t *job = &batch->jobs[batch->count++];
+        memset(job, 0, sizeof(batch_job_t));
+        strcpy(job->rom_path, rom_path);
+        job->frames = frames;
+        if (strcmp(output_path, BATCH_NONE) != 0) {
+            strcpy(job->output_path, output_path);
+        }
+        load_movie_batch(&job->movie, movie_path);
+        load_rom_batch(batch, rom_path);
+    }
+    fclose(file);
+
+    // Share each cartridge between the jobs that run it
+    for (unsigned i = 0; i < batch->count; i++) {
+        batch->jobs[i].rom = get_rom_batch(batch, batch->jobs[i].rom_path);
+    }
+}
+
+void destroy_batch(batch_t *batch) {
+    for (unsigned i = 0; i < batch->count; i++) {
+        if (!is_free_memory(&batch->jobs[i].movie)) {
+            free_memory(&batch->jobs[i].movie);
+        }
+    }
+    for (unsigned i = 0; i < batch->rom_count; i++) {
+        unload_rom(&batch->roms[i]);
+    }
+    free(batch->jobs);
+    free(batch->roms);
+    free(batch->rom_paths);
+}
+
+double get_time_batch() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void run_job_batch(batch_job_t *job) {
+    double start = get_time_batch();
+    emulator_t *emu = (emulator_t *)malloc(sizeof(emulator_t));
+    if (emu == NULL) {
+        fprintf(stderr, "Error: Unable to allocate emulator\n");
+        exit(1);
+    }
+    create_rom_emulator(emu, job->rom);
+
+    FILE *output = NULL;
+    if (job->output_path[0]) {
+        output = fopen(job->output_path, "w");
+        if (output == NULL) {
+            fprintf(stderr,
+                    "Error: Could not open output \"%s\"\n",
+                    job->output_path);
+            exit(1);
+        }
+    }
+
+    // Buttons are released once the movie runs out
+    job->frames_run = 0;
+    job->status = EMULATOR_FRAME;
+    for (unsigned long i = 0; i < job->frames; i++) {
+        unsigned char buttons = i < job->movie.size ? job->movie.buffer[i] : 0;
+        emu->controller.joypad[0] = buttons;
+        job->status = run_frame_emulator(emu);
+        if (job->status == EMULATOR_HALT) {
+            break;
+        }
+        job->frames_run++;
+
+        if (output) {
+            unsigned long long hash = hash_bytes(HASH_SEED,
+                                                 emu->ppu.color_buffer,
+                                                 sizeof(emu->ppu.color_buffer));
+            fprintf(output, "%016llx\n", hash);
+        }
+    }
+
+    job->frame_hash = hash_bytes(HASH_SEED,
+                                 emu->ppu.color_buffer,
+                                 sizeof(emu->ppu.color_buffer));
+    job->ram_hash =
+        hash_bytes(HASH_SEED, emu->cpu_bus.memory, sizeof(emu->cpu_bus.memory));
+
+    if (output) {
+        fclose(output);
+    }
+    destroy_emulator(emu);
+    free(emu);
+    job->seconds = get_time_batch() - start;
+}
+
+void run_task_batch(void *data, unsigned index) {
+    batch_t *batch = data;
+    run_job_batch(&batch->jobs[index]);
+}
+
+void run_batch(batch_t *batch, unsigned workers) {
+    run_pool(batch->count, workers, run_task_batch, batch);
+}
+
+void print_results_batch(batch_t *batch, FILE *file) {
+    fprintf(file,
+            "# job\trom\tframes\tram_hash\tframe_hash\tseconds\tstatus\n");
+    for (unsigned i = 0; i < batch->count; i++) {
+        batch_job_t *job = &batch->jobs[i];
+        fprintf(file,
+                "%u\t%s\t%lu\t%016llx\t%016llx\t%.6f\t%s\n",
+                i,
+                job->rom_path,
+                job->frames_run,
+                job->ram_hash,
+                job->frame_hash,
+                job->seconds,
+                job->status == EMULATOR_HALT ? "halted" : "ok");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <time.h>
+
+#include "./emulator.h"
+#include "./pool.h"
+#include "./utils.h"
+
+// Maximum length of a path in the manifest
+#define BATCH_PATH_SIZE 1024
+
+// Manifest placeholder for an absent movie or output file
+#define BATCH_NONE "-"
+
+/**
+ * @brief A single emulation run and its results.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Cartridge whose image is shared with the job's emulator.
+     *
+     */
+    const rom_t *rom;
+
+    /**
+     * @brief Path of the ROM file.
+     *
+     */
+    char rom_path[BATCH_PATH_SIZE];
+
+    /**
+     * @brief Controller 1 state for each frame, one byte per frame in
+     * shift register order (A, B, Select, Start, Up, Down, Left, Right).
+     *
+     */
+    memory_t movie;
+
+    /**
+     * @brief Number of frames to run.
+     *
+     */
+    unsigned long frames;
+
+    /**
+     * @brief File receiving the hash of every frame, or empty for none.
+     *
+     */
+    char output_path[BATCH_PATH_SIZE];
+
+    /**
+     * @brief Number of frames actually run.
+     *
+     */
+    unsigned long frames_run;
+
+    /**
+     * @brief Hash of the internal RAM after the last frame.
+     *
+     */
+    unsigned long long ram_hash;
+
+    /**
+     * @brief Hash of the last frame.
+     *
+     */
+    unsigned long long frame_hash;
+
+    /**
+     * @brief Wall-clock time spent on the job in seconds.
+     *
+     */
+    double seconds;
+
+    /**
+     * @brief Reason the emulator stopped.
+     *
+     */
+    emulator_status_t status;
+} batch_job_t;
+
+/**
+ * @brief Set of jobs read from a manifest.
+ *
+ * Each line of a manifest describes one job as whitespace separated fields:
+ *
+ *     <rom> <movie or -> <frames> <frame hash output or ->
+ *
+ * Blank lines and lines starting with '#' are ignored.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Jobs in manifest order.
+     *
+     */
+    batch_job_t *jobs;
+
+    /**
+     * @brief Number of jobs.
+     *
+     */
+    unsigned count;
+
+    /**
+     * @brief ROMs loaded once for all jobs, indexed by their path.
+     *
+     */
+    rom_t *roms;
+
+    /**
+     * @brief Path of each loaded ROM.
+     *
+     */
+    char (*rom_paths)[BATCH_PATH_SIZE];
+
+    /**
+     * @brief Number of loaded ROMs.
+     *
+     */
+    unsigned rom_count;
+} batch_t;
+
+/**
+ * @brief Load a batch of jobs from a manifest file.
+ *
+ * @param batch
+ * @param path
+ */
+void load_manifest_batch(batch_t *batch, const char *path);
+
+/**
+ * @brief Free the jobs and the shared ROMs.
+ *
+ * @param batch
+ */
+void destroy_batch(batch_t *batch);
+
+/**
+ * @brief Run a single job on the calling thread.
+ *
+ * @param job
+ */
+void run_job_batch(batch_job_t *job);
+
+/**
+ * @brief Run all jobs on a work-stealing thread pool.
+ *
+ * @param batch
+ * @param workers Number of worker threads, or 0 to match the host
+ */
+void run_batch(batch_t *batch, unsigned workers);
+
+/**
+ * @brief Print the results of every job, one line per job.
+ *
+ * @param batch
+ * @param file
+ */
+void print_results_batch(batch_t *batch, FILE *file);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "./blip.h"
+
+void set_rate_blip(blip_t *blip, double clock_rate, double sample_rate) {
+    blip->factor = (sample_rate / clock_rate) * (1ull << BLIP_FRACTION_BITS);
+}
+
+void create_blip(blip_t *blip,
+                 double clock_rate,
+                 double sample_rate,
+                 unsigned size) {
+    blip->deltas = (float *)calloc(size + BLIP_WIDTH, sizeof(float));
+    blip->size = size;
+    set_rate_blip(blip, clock_rate, sample_rate);
+    blip->offset = 0;
+    blip->integrator = 0;
+
+    // Blackman-windowed sinc just below the output Nyquist frequency, delayed
+    // by half the kernel width and normalized so every step is exact at DC
+    const double cutoff = 0.9;
+    for (unsigned phase = 0; phase < BLIP_PHASES; phase++) {
+        double sum = 0;
+        double kernel[BLIP_WIDTH];
+        for (unsigned i = 0; i < BLIP_WIDTH; i++) {
+            double x = i - BLIP_WIDTH / 2.0 - (double)phase / BLIP_PHASES;
+            double angle = M_PI * x / (BLIP_WIDTH / 2.0);
+            double window = 0.42 + 0.5 * cos(angle) + 0.08 * cos(2 * angle);
+            double sinc = x == 0 ? 1 : sin(M_PI * cutoff * x) /
+                                           (M_PI * cutoff * x);
+            kernel[i] = sinc * window;
+            sum += kernel[i];
+        }
+        for (unsigned i = 0; i < BLIP_WIDTH; i++) {
+            blip->kernel[phase][i] = kernel[i] / sum;
+        }
+    }
+}
+
+void resize_blip(blip_t *blip, unsigned size) {
+    if (size <= blip->size) {
+        return;
+    }
+    float *deltas =
+        (float *)realloc(blip->deltas, (size + BLIP_WIDTH) * sizeof(float));
+    if (!deltas) {
+        fprintf(stderr, "Error: Unable to allocate %u blip samples\n", size);
+        exit(1);
+    }
+    memset(deltas + blip->size + BLIP_WIDTH,
+           0,
+           (size - blip->size) * sizeof(float));
+    blip->deltas = deltas;
+    blip->size = size;
+}
+
+void destroy_blip(blip_t *blip) { free(blip->deltas); }
+
+void clear_blip(blip_t *blip) {
+    memset(blip->deltas, 0, (blip->size + BLIP_WIDTH) * sizeof(float));
+    blip->offset = 0;
+    blip->integrator = 0;
+}
+
+void add_delta_blip(blip_t *blip, unsigned long time, float delta) {
+    unsigned long long position = blip->offset + time * blip->factor;
+    unsigned long index = position >> BLIP_FRACTION_BITS;
+    if (index >= blip->size) {
+        return;
+    }
+
+    // Top bits of the fraction select the kernel phase
+    unsigned phase =
+        (position >> (BLIP_FRACTION_BITS - BLIP_PHASE_BITS)) % BLIP_PHASES;
+    float *kernel = blip->kernel[phase];
+    float *deltas = blip->deltas + index;
+#if defined(__SSE__)
+    __m128 scale = _mm_set1_ps(delta);
+    for (unsigned i = 0; i < BLIP_WIDTH; i += 4) {
+        __m128 taps = _mm_mul_ps(_mm_loadu_ps(kernel + i), scale);
+        _mm_storeu_ps(deltas + i, _mm_add_ps(_mm_loadu_ps(deltas + i), taps));
+    }
+#else
+    for (unsigned i = 0; i < BLIP_WIDTH; i++) {
+        deltas[i] += kernel[i] * delta;
+    }
+#endif
+}
+
+void end_frame_blip(blip_t *blip, unsigned long time) {
+    blip->offset += time * blip->factor;
+}
+
+unsigned get_available_blip(blip_t *blip) {
+    unsigned long available = blip->offset >> BLIP_FRACTION_BITS;
+    return min(available, blip->size);
+}
+
+unsigned read_samples_blip(blip_t *blip, float *dst, unsigned count) {
+    count = min(count, get_available_blip(blip));
+    for (unsigned i = 0; i < count; i++) {
+        blip->integrator += blip->deltas[i];
+        dst[i] = blip->integrator;
+    }
+
+    // Shift the unread deltas and the kernel tails to the front
+    unsigned remaining = blip->size + BLIP_WIDTH - count;
+    memmove(blip->deltas, blip->deltas + count, remaining * sizeof(float));
+    memset(blip->deltas + remaining, 0, count * sizeof(float));
+    blip->offset -= (unsigned long long)count << BLIP_FRACTION_BITS;
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef BLIP_H
+#define BLIP_H
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "./buffer.h"
+
+// Resolution and length of the band-limited step kernel, the length being a
+// multiple of the 4-float SIMD width
+#define BLIP_PHASE_BITS 5
+#define BLIP_PHASES     (1 << BLIP_PHASE_BITS)
+#define BLIP_WIDTH      16
+
+// Fractional bits of sample positions
+#define BLIP_FRACTION_BITS 32
+
+/**
+ * @brief Band-limited synthesis buffer.
+ *
+ * Sources add amplitude deltas at clock times instead of writing a sample per
+ * clock. Each delta is spread over nearby output samples by a windowed-sinc
+ * kernel, and reading the buffer integrates the deltas back into a signal
+ * free of the aliasing a naive square wave would have.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Band-limited impulse for each sub-sample phase.
+     *
+     */
+    float kernel[BLIP_PHASES][BLIP_WIDTH];
+
+    /**
+     * @brief Pending deltas, with room for the kernel past the last sample.
+     *
+     */
+    float *deltas;
+
+    /**
+     * @brief Capacity in output samples.
+     *
+     */
+    unsigned size;
+
+    /**
+     * @brief Output samples per clock in fixed point.
+     *
+     */
+    unsigned long long factor;
+
+    /**
+     * @brief Sample position of the start of the current frame in fixed point.
+     *
+     */
+    unsigned long long offset;
+
+    /**
+     * @brief Running sum of the deltas that have been read.
+     *
+     */
+    float integrator;
+} blip_t;
+
+/**
+ * @brief Create the buffer.
+ *
+ * @param blip
+ * @param clock_rate Input clocks per second.
+ * @param sample_rate Output samples per second.
+ * @param size Capacity in output samples.
+ */
+void create_blip(blip_t *blip,
+                 double clock_rate,
+                 double sample_rate,
+                 unsigned size);
+
+/**
+ * @brief Change the ratio between clocks and output samples, taking effect at
+ * the start of the next frame.
+ *
+ * @param blip
+ * @param clock_rate Input clocks per second.
+ * @param sample_rate Output samples per second.
+ */
+void set_rate_blip(blip_t *blip, double clock_rate, double sample_rate);
+
+/**
+ * @brief Grow the capacity, keeping pending deltas and samples.
+ *
+ * @param blip
+ * @param size Capacity in output samples, ignored if not larger.
+ */
+void resize_blip(blip_t *blip, unsigned size);
+
+/**
+ * @brief Destroy the buffer.
+ *
+ * @param blip
+ */
+void destroy_blip(blip_t *blip);
+
+/**
+ * @brief Drop all pending deltas and samples.
+ *
+ * @param blip
+ */
+void clear_blip(blip_t *blip);
+
+/**
+ * @brief Add an amplitude change at a clock time within the current frame.
+ *
+ * @param blip
+ * @param time
+ * @param delta
+ */
+void add_delta_blip(blip_t *blip, unsigned long time, float delta);
+
+/**
+ * @brief End the current frame, making its samples available.
+ *
+ * @param blip
+ * @param time Length of the frame in clocks.
+ */
+void end_frame_blip(blip_t *blip, unsigned long time);
+
+/**
+ * @brief Get the number of samples available to read.
+ *
+ * @param blip
+ * @return unsigned
+ */
+unsigned get_available_blip(blip_t *blip);
+
+/**
+ * @brief Read up to count samples, returning the number read.
+ *
+ * @param blip
+ * @param dst
+ * @param count
+ * @return unsigned
+ */
+unsigned read_samples_blip(blip_t *blip, float *dst, unsigned count);
+
+#endif
\ No newline at end of file
@@ -2,8 +2,10 @@
 
 void create_buffer(buffer_t *buffer, unsigned capacity) {
     buffer->memory = allocate_memory(capacity);
-    buffer->read = 0;
-    buffer->write = 0;
+    atomic_init(&buffer->read, 0);
+    atomic_init(&buffer->write, 0);
+    atomic_init(&buffer->underruns, 0);
+    atomic_init(&buffer->overruns, 0);
     buffer->mask = capacity - 1;
 
     if (capacity == 0 || (capacity & buffer->mask)) {
@@ -17,13 +19,35 @@ void create_buffer(buffer_t *buffer, unsigned capacity) {
 void destroy_buffer(buffer_t *buffer) { free_memory(&buffer->memory); }
 
 unsigned get_size_buffer(buffer_t *buffer) {
-    return buffer->write - buffer->read;
+    unsigned read = atomic_load_explicit(&buffer->read, memory_order_acquire);
+    unsigned write = atomic_load_explicit(&buffer->write, memory_order_acquire);
+
+    // Reading the pointers separately may observe a stale read pointer
+    return min(write - read, buffer->memory.size);
+}
+
+unsigned get_capacity_buffer(buffer_t *buffer) { return buffer->memory.size; }
+
+float get_fill_buffer(buffer_t *buffer) {
+    return (float)get_size_buffer(buffer) / buffer->memory.size;
+}
+
+unsigned get_underruns_buffer(buffer_t *buffer) {
+    return atomic_load_explicit(&buffer->underruns, memory_order_relaxed);
+}
+
+unsigned get_overruns_buffer(buffer_t *buffer) {
+    return atomic_load_explicit(&buffer->overruns, memory_order_relaxed);
 }
 
 unsigned read_buffer(buffer_t *buffer, unsigned char *dst, unsigned n) {
+    // Acquire the producer's writes before copying them out
+    unsigned read = atomic_load_explicit(&buffer->read, memory_order_relaxed);
+    unsigned write = atomic_load_explicit(&buffer->write, memory_order_acquire);
+
     // Compute copy partitions
-    unsigned size = get_size_buffer(buffer);
-    unsigned offset = buffer->read & buffer->mask;
+    unsigned size = write - read;
+    unsigned offset = read & buffer->mask;
     unsigned length = min(n, size);
     unsigned l_length = min(length, buffer->memory.size - offset);
     unsigned r_length = length - l_length;
@@ -33,15 +57,23 @@ unsigned read_buffer(buffer_t *buffer, unsigned char *dst, unsigned n) {
     memcpy(dst, src + offset, l_length);
     memcpy(dst + l_length, src, r_length);
 
-    buffer->read += length;
+    // Release the space only after the copy is complete
+    atomic_store_explicit(&buffer->read, read + length, memory_order_release);
+    if (length < n) {
+        atomic_fetch_add_explicit(&buffer->underruns, 1, memory_order_relaxed);
+    }
     return length;
 }
 
 unsigned write_buffer(buffer_t *buffer, unsigned char *src, unsigned n) {
+    // Acquire the consumer's reads before overwriting the space
+    unsigned read = atomic_load_explicit(&buffer->read, memory_order_acquire);
+    unsigned write = atomic_load_explicit(&buffer->write, memory_order_relaxed);
+
     // Compute copy partitions
-    unsigned size = get_size_buffer(buffer);
+    unsigned size = write - read;
     unsigned remaining = buffer->memory.size - size;
-    unsigned offset = buffer->write & buffer->mask;
+    unsigned offset = write & buffer->mask;
     unsigned length = min(n, remaining);
     unsigned l_length = min(length, buffer->memory.size - offset);
 
@@ -50,11 +82,15 @@ unsigned write_buffer(buffer_t *buffer, unsigned char *src, unsigned n) {
     memcpy(dst + offset, src, l_length);
     memcpy(dst, src + l_length, length - l_length);
 
-    buffer->write += length;
+    // Publish the values only after the copy is complete
+    atomic_store_explicit(&buffer->write, write + length, memory_order_release);
+    if (length < n) {
+        atomic_fetch_add_explicit(&buffer->overruns, 1, memory_order_relaxed);
+    }
     return length;
 }
 
 void clear_buffer(buffer_t *buffer) {
-    buffer->read = 0;
-    buffer->write = 0;
+    unsigned write = atomic_load_explicit(&buffer->write, memory_order_acquire);
+    atomic_store_explicit(&buffer->read, write, memory_order_release);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef BUFFER_H
 #define BUFFER_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <string.h>
 
@@ -12,6 +13,10 @@
 /**
  * @brief Circular buffer.
  *
+ * Safe without locks for a single producer thread writing and a single
+ * consumer thread reading. Each side only stores its own pointer, publishing
+ * the copied bytes with release ordering.
+ *
  */
 typedef struct {
     /**
@@ -21,22 +26,34 @@ typedef struct {
     memory_t memory;
 
     /**
-     * @brief Read pointer.
+     * @brief Read pointer, advanced by the consumer.
      *
      */
-    unsigned read;
+    atomic_uint read;
 
     /**
-     * @brief Write pointer.
+     * @brief Write pointer, advanced by the producer.
      *
      */
-    unsigned write;
+    atomic_uint write;
 
     /**
      * @brief Masking value.
      *
      */
     unsigned mask;
+
+    /**
+     * @brief Number of reads that found fewer values than requested.
+     *
+     */
+    atomic_uint underruns;
+
+    /**
+     * @brief Number of writes that found less space than requested.
+     *
+     */
+    atomic_uint overruns;
 } buffer_t;
 
 /**
@@ -62,9 +79,41 @@ void destroy_buffer(buffer_t *buffer);
  */
 unsigned get_size_buffer(buffer_t *buffer);
 
+/**
+ * @brief Get the capacity of a buffer.
+ *
+ * @param buffer
+ * @return unsigned
+ */
+unsigned get_capacity_buffer(buffer_t *buffer);
+
+/**
+ * @brief Get the fill level of a buffer as a fraction of its capacity.
+ *
+ * @param buffer
+ * @return float
+ */
+float get_fill_buffer(buffer_t *buffer);
+
+/**
+ * @brief Get the number of short reads since the buffer was created.
+ *
+ * @param buffer
+ * @return unsigned
+ */
+unsigned get_underruns_buffer(buffer_t *buffer);
+
+/**
+ * @brief Get the number of short writes since the buffer was created.
+ *
+ * @param buffer
+ * @return unsigned
+ */
+unsigned get_overruns_buffer(buffer_t *buffer);
+
 /**
  * @brief Read up to n values from the buffer, returning the number of elements
- * read.
+ * read. Only called from the consumer thread.
  *
  * @param buffer
  * @param dst
@@ -75,7 +124,7 @@ unsigned read_buffer(buffer_t *buffer, unsigned char *dst, unsigned n);
 
 /**
  * @brief Write up to n values to the buffer, returning the number of elements
- * written.
+ * written. Only called from the producer thread.
  *
  * @param buffer
  * @param src
@@ -85,7 +134,8 @@ unsigned read_buffer(buffer_t *buffer, unsigned char *dst, unsigned n);
 unsigned write_buffer(buffer_t *buffer, unsigned char *src, unsigned n);
 
 /**
- * @brief Clear the buffer.
+ * @brief Clear the buffer by discarding its values. Only called from the
+ * consumer thread.
  *
  * @param buffer
  */
@@ -0,0 +1,124 @@
+#include "./callgraph.h"
+#include "./cpu.h"
+
+void create_callgraph(callgraph_t *graph, unsigned long cycles) {
+    graph->node_capacity = 256;
+    graph->nodes = (callgraph_node_t *)malloc(graph->node_capacity *
+                                              sizeof(callgraph_node_t));
+    graph->node_count = 1;
+    memset(&graph->nodes[0], 0, sizeof(callgraph_node_t));
+
+    graph->stack[0].node = 0;
+    graph->stack[0].s = CALLGRAPH_ROOT_STACK;
+    graph->depth = 1;
+    graph->cycles = cycles;
+}
+
+void destroy_callgraph(callgraph_t *graph) { free(graph->nodes); }
+
+void charge_callgraph(callgraph_t *graph, unsigned long cycles) {
+    unsigned node = graph->stack[graph->depth - 1].node;
+    graph->nodes[node].cycles += cycles - graph->cycles;
+    graph->cycles = cycles;
+}
+
+unsigned get_child_callgraph(callgraph_t *graph,
+                             unsigned parent,
+                             address_t address,
+                             address_t vector) {
+    unsigned child = graph->nodes[parent].child;
+    while (child) {
+        callgraph_node_t *node = &graph->nodes[child];
+        if (node->address == address && node->vector == vector) {
+            return child;
+        }
+        child = node->sibling;
+    }
+
+    // First call along this path
+    if (graph->node_count == graph->node_capacity) {
+        graph->node_capacity *= 2;
+        graph->nodes = (callgraph_node_t *)realloc(
+            graph->nodes,
+            graph->node_capacity * sizeof(callgraph_node_t));
+    }
+    child = graph->node_count++;
+    callgraph_node_t *node = &graph->nodes[child];
+    node->address = address;
+    node->vector = vector;
+    node->parent = parent;
+    node->child = 0;
+    node->sibling = graph->nodes[parent].child;
+    node->cycles = 0;
+    graph->nodes[parent].child = child;
+    return child;
+}
+
+void enter_callgraph(callgraph_t *graph,
+                     address_t address,
+                     address_t vector,
+                     unsigned char s,
+                     unsigned long cycles) {
+    charge_callgraph(graph, cycles);
+
+    // Runaway recursion keeps charging the deepest frame
+    if (graph->depth == CALLGRAPH_DEPTH) {
+        return;
+    }
+    unsigned parent = graph->stack[graph->depth - 1].node;
+    callgraph_frame_t *frame = &graph->stack[graph->depth++];
+    frame->node = get_child_callgraph(graph, parent, address, vector);
+    frame->s = s;
+}
+
+void leave_callgraph(callgraph_t *graph,
+                     unsigned char s,
+                     unsigned long cycles) {
+    charge_callgraph(graph, cycles);
+
+    // Unwind every frame whose return address has been pulled
+    while (graph->depth > 1 && graph->stack[graph->depth - 1].s < s) {
+        graph->depth--;
+    }
+}
+
+void resync_callgraph(callgraph_t *graph,
+                      unsigned char s,
+                      unsigned long cycles) {
+    graph->cycles = cycles;
+    while (graph->depth > 1 && graph->stack[graph->depth - 1].s < s) {
+        graph->depth--;
+    }
+}
+
+void write_frame_callgraph(callgraph_t *graph, unsigned index, FILE *file) {
+    callgraph_node_t *node = &graph->nodes[index];
+    if (index == 0) {
+        fputs("reset", file);
+        return;
+    }
+    write_frame_callgraph(graph, node->parent, file);
+    switch (node->vector) {
+    case CPU_VEC_NMI:
+        fprintf(file, ";nmi:$%04X", node->address);
+        break;
+    case CPU_VEC_IRQ_BRK:
+        fprintf(file, ";irq:$%04X", node->address);
+        break;
+    case CPU_VEC_RESET:
+        fprintf(file, ";reset:$%04X", node->address);
+        break;
+    default:
+        fprintf(file, ";$%04X", node->address);
+        break;
+    }
+}
+
+void write_folded_callgraph(callgraph_t *graph, FILE *file) {
+    for (unsigned i = 0; i < graph->node_count; i++) {
+        if (graph->nodes[i].cycles) {
+            write_frame_callgraph(graph, i, file);
+            fprintf(file, " %lu\n", graph->nodes[i].cycles);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "./memory.h"
+
+// Maximum depth of the shadow call stack
+#define CALLGRAPH_DEPTH 256
+
+// Stack pointer recorded for the root frame, above any real stack pointer
+#define CALLGRAPH_ROOT_STACK 0x100
+
+/**
+ * @brief Node of the call tree, one per distinct call path.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Entry point of the subroutine or interrupt handler.
+     *
+     */
+    address_t address;
+
+    /**
+     * @brief Interrupt vector that entered the handler, 0 for subroutines.
+     *
+     */
+    address_t vector;
+
+    /**
+     * @brief Index of the parent node.
+     *
+     */
+    unsigned parent;
+
+    /**
+     * @brief Index of the first child node, 0 if none.
+     *
+     */
+    unsigned child;
+
+    /**
+     * @brief Index of the next sibling node, 0 if none.
+     *
+     */
+    unsigned sibling;
+
+    /**
+     * @brief CPU cycles spent in this node, excluding its callees.
+     *
+     */
+    unsigned long cycles;
+} callgraph_node_t;
+
+/**
+ * @brief Frame of the shadow call stack.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Index of the call tree node.
+     *
+     */
+    unsigned node;
+
+    /**
+     * @brief CPU stack pointer after the return address was pushed.
+     *
+     */
+    unsigned s;
+} callgraph_frame_t;
+
+/**
+ * @brief Guest code profiler attributing CPU cycles to 6502 subroutines.
+ *
+ * The CPU notifies the profiler on JSR, RTS, RTI and interrupt entry, and the
+ * cycles elapsed since the previous notification are charged to the frame on
+ * top of the shadow call stack. Returns unwind every frame whose stack pointer
+ * lies below the restored one, so routines that discard their return address
+ * or use RTS as an indirect jump do not desynchronize the stack.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Call tree, the root node is at index 0.
+     *
+     */
+    callgraph_node_t *nodes;
+
+    /**
+     * @brief Number of nodes.
+     *
+     */
+    unsigned node_count;
+
+    /**
+     * @brief Capacity of the nodes array.
+     *
+     */
+    unsigned node_capacity;
+
+    /**
+     * @brief Shadow call stack.
+     *
+     */
+    callgraph_frame_t stack[CALLGRAPH_DEPTH];
+
+    /**
+     * @brief Number of frames on the shadow call stack.
+     *
+     */
+    unsigned depth;
+
+    /**
+     * @brief CPU cycle count of the last notification.
+     *
+     */
+    unsigned long cycles;
+} callgraph_t;
+
+/**
+ * @brief Create the profiler.
+ *
+ * @param graph
+ * @param cycles Current CPU cycle count.
+ */
+void create_callgraph(callgraph_t *graph, unsigned long cycles);
+
+/**
+ * @brief Destroy the profiler.
+ *
+ * @param graph
+ */
+void destroy_callgraph(callgraph_t *graph);
+
+/**
+ * @brief Charge the cycles elapsed since the last notification to the
+ * current frame.
+ *
+ * @param graph
+ * @param cycles Current CPU cycle count.
+ */
+void charge_callgraph(callgraph_t *graph, unsigned long cycles);
+
+/**
+ * @brief Enter a subroutine or interrupt handler.
+ *
+ * @param graph
+ * @param address Entry point.
+ * @param vector Interrupt vector, 0 for JSR.
+ * @param s CPU stack pointer after the return address was pushed.
+ * @param cycles Current CPU cycle count.
+ */
+void enter_callgraph(callgraph_t *graph,
+                     address_t address,
+                     address_t vector,
+                     unsigned char s,
+                     unsigned long cycles);
+
+/**
+ * @brief Return from a subroutine or interrupt handler.
+ *
+ * @param graph
+ * @param s CPU stack pointer after the return address was pulled.
+ * @param cycles Current CPU cycle count.
+ */
+void leave_callgraph(callgraph_t *graph,
+                     unsigned char s,
+                     unsigned long cycles);
+
+/**
+ * @brief Resynchronize with a CPU whose state was restored, without charging
+ * the cycles that were rolled back. Frames pulled off the restored stack are
+ * unwound.
+ *
+ * @param graph
+ * @param s Restored CPU stack pointer.
+ * @param cycles Restored CPU cycle count.
+ */
+void resync_callgraph(callgraph_t *graph,
+                      unsigned char s,
+                      unsigned long cycles);
+
+/**
+ * @brief Write the call tree in the folded stack format read by flamegraph
+ * tools, one line per call path with its self cycles.
+ *
+ * @param graph
+ * @param file
+ */
+void write_folded_callgraph(callgraph_t *graph, FILE *file);
+
+#endif
\ No newline at end of file
@@ -1,31 +1,70 @@
 #include "./color.h"
 
-color_t create_color(unsigned char palette_byte,
-                     bool grayscale,
-                     bool em_r,
-                     bool em_g,
-                     bool em_b) {
-    if (grayscale) {
-        palette_byte &= 0x30;
-    }
-
+void emphasize_color_table(color_t *table) {
     // Apply emphasis
     // TODO: Implement accurate NTSC signal emulation
-    color_t color = COLOR_PALETTE[palette_byte];
-    if (em_r) {
-        color.r = min(color.r * 1.5, 0xff);
-        color.g = color.g * 0.5;
-        color.b = color.b * 0.5;
+    for (unsigned i = 64; i < COLOR_INDICES; i++) {
+        color_t color = table[i & 0x3F];
+        if (i & 0x40) {
+            color.r = min(color.r * 3 / 2, 0xff);
+            color.g = color.g / 2;
+            color.b = color.b / 2;
+        }
+        if (i & 0x80) {
+            color.r = color.r / 2;
+            color.g = min(color.g * 3 / 2, 0xff);
+            color.b = color.b / 2;
+        }
+        if (i & 0x100) {
+            color.r = color.r / 2;
+            color.g = color.g / 2;
+            color.b = min(color.b * 3 / 2, 0xff);
+        }
+        table[i] = color;
     }
-    if (em_g) {
-        color.r = color.r * 0.5;
-        color.g = min(color.g * 1.5, 0xff);
-        color.b = color.b * 0.5;
+}
+
+void create_color_table(color_t *table) {
+    memcpy(table, COLOR_PALETTE, sizeof(COLOR_PALETTE));
+    emphasize_color_table(table);
+}
+
+void load_color_table(color_t *table, const char *path) {
+    // Open file
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Could not open file \"%s\"\n", path);
+        exit(1);
     }
-    if (em_b) {
-        color.r = color.r * 0.5;
-        color.g = color.g * 0.5;
-        color.b = min(color.b * 1.5, 0xff);
+
+    // Get file size
+    fseek(file, 0, SEEK_END);
+    unsigned long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned entries = size / 3;
+    if (size % 3 || (entries != 64 && entries != COLOR_INDICES)) {
+        fprintf(stderr, "Error: Invalid palette file \"%s\"\n", path);
+        fclose(file);
+        exit(1);
     }
-    return color;
-}
+
+    // Read the RGB triplets
+    for (unsigned i = 0; i < entries; i++) {
+        unsigned char rgb[3];
+        if (fread(rgb, 1, 3, file) != 3) {
+            fprintf(stderr, "Error: Could not read file \"%s\"\n", path);
+            fclose(file);
+            exit(1);
+        }
+        table[i].r = rgb[0];
+        table[i].g = rgb[1];
+        table[i].b = rgb[2];
+    }
+    fclose(file);
+
+    // Approximate emphasis if the palette does not define it
+    if (entries == 64) {
+        emphasize_color_table(table);
+    }
+}
\ No newline at end of file
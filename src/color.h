@@ -15,6 +15,13 @@ typedef struct {
     unsigned char b;
 } color_t;
 
+// Number of color indices (6-bit palette value and 3 emphasis bits)
+#define COLOR_INDICES 512
+
+// Number of entries in a color table, greyscale is already applied by the PPU
+// palette read
+#define COLOR_TABLE_SIZE COLOR_INDICES
+
 /**
  * @brief 2C02 color palette look-up table for the NES.
  *
@@ -45,19 +52,23 @@ static const color_t COLOR_PALETTE[64] = {
 };
 
 /**
- * @brief Create an RGB color object.
+ * @brief Fill a look-up table that maps each color index to its RGB color
+ * using the built-in 2C02 palette. The low 6 bits of an index are the
+ * palette value and the next 3 bits are the red, green and blue emphasis
+ * flags.
+ *
+ * @param table
+ */
+void create_color_table(color_t *table);
+
+/**
+ * @brief Fill a color look-up table from a .pal file. Both 64-entry
+ * palettes, with emphasis approximated, and full 512-entry NES 2.0 palettes
+ * with one 64-entry block per emphasis combination are supported.
  *
- * @param palette_byte
- * @param grayscale
- * @param em_r
- * @param em_g
- * @param em_b
- * @return color_t
+ * @param table
+ * @param path
  */
-color_t create_color(unsigned char palette_byte,
-                     bool grayscale,
-                     bool em_r,
-                     bool em_g,
-                     bool em_b);
+void load_color_table(color_t *table, const char *path);
 
 #endif
\ No newline at end of file
@@ -19,10 +19,14 @@ void create_cpu(cpu_t *cpu, cpu_bus_t *bus, interrupt_t *interrupt) {
 
     // Cycles on reset
     cpu->cycles = 7;
+    cpu->instructions = 0;
+    cpu->nmi_assert = false;
 
     // Peripherals
     cpu->bus = bus;
     cpu->interrupt = interrupt;
+    cpu->callgraph = NULL;
+    cpu->trace = NULL;
 }
 
 void destroy_cpu(cpu_t *cpu) {}
@@ -50,78 +54,54 @@ unsigned char pop_stack_cpu(cpu_t *cpu) {
     return read_cpu_bus(cpu->bus, 0x100 | cpu->s);
 }
 
-void read_state_cpu(cpu_t *cpu, char *buffer, unsigned buffer_size) {
-    unsigned char opcode = read_cpu_bus(cpu->bus, cpu->pc);
-    operation_t operation = OP_TABLE[opcode];
-    unsigned char term_count = ADDRESS_MODE_SIZES[operation.address_mode];
-    switch (term_count) {
-    case 1:
-        snprintf(buffer,
-                 buffer_size,
-                 "%04X  %02X        A:%02X X:%02X Y:%02X P:%02X SP:%02X "
-                 "PPU:%3d,%3d CYC:"
-                 "%lu",
-                 cpu->pc,
-                 opcode,
-                 cpu->a,
-                 cpu->x,
-                 cpu->y,
-                 get_status_cpu(cpu),
-                 cpu->s,
-                 cpu->bus->ppu->scanline,
-                 cpu->bus->ppu->dot,
-                 cpu->cycles);
-        break;
-    case 2:
-        snprintf(buffer,
-                 buffer_size,
-                 "%04X  %02X %02X     A:%02X X:%02X Y:%02X P:%02X SP:%02X "
-                 "PPU:%3d,%3d CYC:"
-                 "%lu",
-                 cpu->pc,
-                 opcode,
-                 read_cpu_bus(cpu->bus, cpu->pc + 1),
-                 cpu->a,
-                 cpu->x,
-                 cpu->y,
-                 get_status_cpu(cpu),
-                 cpu->s,
-                 cpu->bus->ppu->scanline,
-                 cpu->bus->ppu->dot,
-                 cpu->cycles);
-        break;
-    case 3:
-        snprintf(buffer,
-                 buffer_size,
-                 "%04X  %02X %02X %02X  A:%02X X:%02X Y:%02X P:%02X SP:%02X "
-                 "PPU:%3d,%3d CYC:"
-                 "%lu",
-                 cpu->pc,
-                 opcode,
-                 read_cpu_bus(cpu->bus, cpu->pc + 1),
-                 read_cpu_bus(cpu->bus, cpu->pc + 2),
-                 cpu->a,
-                 cpu->x,
-                 cpu->y,
-                 get_status_cpu(cpu),
-                 cpu->s,
-                 cpu->bus->ppu->scanline,
-                 cpu->bus->ppu->dot,
-                 cpu->cycles);
-        break;
-    default:
-        break;
+CPU_INLINE unsigned char peek_cpu(cpu_t *cpu, address_t address) {
+    // Program bytes are almost always in directly mapped pages
+    unsigned char *page = cpu->bus->map.read[address / MEMORY_PAGE_SIZE];
+    if (page) {
+        return page[address % MEMORY_PAGE_SIZE];
     }
+    return peek_cpu_bus(cpu->bus, address);
+}
+
+void read_entry_cpu(cpu_t *cpu, trace_entry_t *entry) {
+    // Before its deadline the lagging PPU only steps dot by dot, so its
+    // position can be extrapolated without catching it up. The pre-render
+    // line may skip a dot, so it is synchronized instead.
+    cpu_bus_t *bus = cpu->bus;
+    ppu_t *ppu = bus->ppu;
+    poll_ppu_cpu_bus(bus);
+    unsigned long position =
+        ppu->scanline * PPU_LINEDOTS + ppu->dot + bus->clock - ppu->cycles;
+    if (position >= PPU_SCANLINE_PRERENDER * PPU_LINEDOTS) {
+        sync_ppu_cpu_bus(bus);
+        position = ppu->scanline * PPU_LINEDOTS + ppu->dot;
+    }
+    entry->cycles = cpu->cycles;
+    entry->pc = cpu->pc;
+    entry->scanline = position / PPU_LINEDOTS;
+    entry->dot = position % PPU_LINEDOTS;
+    entry->opcode = peek_cpu(cpu, cpu->pc);
+    entry->operands[0] = peek_cpu(cpu, cpu->pc + 1);
+    entry->operands[1] = peek_cpu(cpu, cpu->pc + 2);
+    entry->a = cpu->a;
+    entry->x = cpu->x;
+    entry->y = cpu->y;
+    entry->p = get_status_cpu(cpu);
+    entry->s = cpu->s;
+}
+
+void read_state_cpu(cpu_t *cpu, char *buffer, unsigned buffer_size) {
+    trace_entry_t entry;
+    read_entry_cpu(cpu, &entry);
+    format_entry_trace(&entry, buffer, buffer_size);
 }
 
 void tick_cpu(cpu_t *cpu) {
     cpu->cycles++;
-    update_ppu(cpu->bus->ppu);
+    cpu->bus->clock += 3;
     if (cpu->cycles % 2 == 0) {
         update_apu(cpu->bus->apu);
     }
-    update_ppu(cpu->bus->ppu);
-    update_ppu(cpu->bus->ppu);
 }
 
 unsigned char fetch_op_cpu(cpu_t *cpu) {
@@ -137,24 +117,22 @@ unsigned char fetch_op_cpu(cpu_t *cpu) {
 
     // Assert the NMI interrupt after the first PPU tick
     // This is one of the 4 CPU-PPU clock alignments
-    update_ppu(cpu->bus->ppu);
+    cpu->bus->clock++;
     if (cpu->cycles % 2 == 0) {
         update_apu(cpu->bus->apu);
     }
+    poll_ppu_cpu_bus(cpu->bus);
     if (get_nmi_interrupt(cpu->interrupt)) {
         cpu->nmi_assert = true;
     }
-    update_ppu(cpu->bus->ppu);
-    update_ppu(cpu->bus->ppu);
+    cpu->bus->clock += 2;
 
     // No interrupts, next instruction from program counter
     unsigned char opcode = read_cpu_bus(cpu->bus, cpu->pc++);
     return opcode;
 }
 
-address_t decode_op_cpu(cpu_t *cpu, unsigned char opcode) {
-    operation_t operation = OP_TABLE[opcode];
-
+CPU_INLINE address_t decode_op_cpu(cpu_t *cpu, operation_t operation) {
     // Skip decoding for special opcodes
     switch (operation.mnemonic) {
     case OP_JSR:
@@ -228,7 +206,7 @@ address_t decode_op_cpu(cpu_t *cpu, unsigned char opcode) {
         address_t address = base_address + cpu->y;
         if ((base_address & 0xff00) != (address & 0xff00) ||
             operation.group & OPGROUP_W) {
-            read_cpu_bus(cpu->bus, (adh << 8) | (adl + cpu->y));
+            read_cpu_bus(cpu->bus, (adh << 8) | ((adl + cpu->y) & 0xff));
             tick_cpu(cpu);
         }
         return address;
@@ -263,7 +241,7 @@ address_t decode_op_cpu(cpu_t *cpu, unsigned char opcode) {
 
         if ((base_address & 0xff00) != (address & 0xff00) ||
             operation.group & OPGROUP_W) {
-            read_cpu_bus(cpu->bus, (adh << 8) | (adl + cpu->y));
+            read_cpu_bus(cpu->bus, (adh << 8) | ((adl + cpu->y) & 0xff));
             tick_cpu(cpu);
         }
         return address;
@@ -281,7 +259,7 @@ address_t decode_op_cpu(cpu_t *cpu, unsigned char opcode) {
 
         if ((base_address & 0xff00) != (address & 0xff00) ||
             operation.group & OPGROUP_W) {
-            read_cpu_bus(cpu->bus, (adh << 8) | (adl + cpu->x));
+            read_cpu_bus(cpu->bus, (adh << 8) | ((adl + cpu->x) & 0xff));
             tick_cpu(cpu);
         }
         return address;
@@ -305,9 +283,10 @@ address_t decode_op_cpu(cpu_t *cpu, unsigned char opcode) {
     }
 }
 
-bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
-    operation_t operation = OP_TABLE[opcode];
-
+CPU_INLINE bool execute_op_cpu(cpu_t *cpu,
+                               unsigned char opcode,
+                               operation_t operation,
+                               address_t operand) {
     switch (operation.mnemonic) {
     case OP_JMP:
         cpu->pc = operand;
@@ -336,6 +315,9 @@ bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
         unsigned char adh = read_cpu_bus(cpu->bus, cpu->pc++);
         cpu->pc = (adh << 8) | adl;
         tick_cpu(cpu);
+        if (cpu->callgraph) {
+            enter_callgraph(cpu->callgraph, cpu->pc, 0, cpu->s, cpu->cycles);
+        }
         break;
     }
     case OP_NOP:
@@ -463,6 +445,9 @@ bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
         unsigned char pch = pop_stack_cpu(cpu);
         cpu->pc = ((pch << 8) | pcl) + 1;
         tick_cpu(cpu);
+        if (cpu->callgraph) {
+            leave_callgraph(cpu->callgraph, cpu->s, cpu->cycles);
+        }
         break;
     case OP_SEI:
         cpu->status.i = true;
@@ -683,6 +668,9 @@ bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
         unsigned char pch = pop_stack_cpu(cpu);
         cpu->pc = (pch << 8) | pcl;
         tick_cpu(cpu);
+        if (cpu->callgraph) {
+            leave_callgraph(cpu->callgraph, cpu->s, cpu->cycles);
+        }
     } break;
     case OP_LSR: {
         unsigned char val = operation.address_mode == ADDR_ACCUMULATOR
@@ -985,11 +973,43 @@ bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
         write_cpu_bus(cpu->bus, target, val);
         tick_cpu(cpu);
     } break;
+    case OP_SHA: {
+        // Stores of the high address byte plus one replace it on page crossing
+        address_t target = operand;
+        address_t base = target - cpu->y;
+        unsigned char val = cpu->a & cpu->x & ((base >> 8) + 1);
+        if ((base & 0xff00) != (target & 0xff00)) {
+            target = (target & 0xff) | (val << 8);
+        }
+        write_cpu_bus(cpu->bus, target, val);
+        tick_cpu(cpu);
+    } break;
+    case OP_TAS: {
+        address_t target = operand;
+        address_t base = target - cpu->y;
+        cpu->s = cpu->a & cpu->x;
+        unsigned char val = cpu->s & ((base >> 8) + 1);
+        if ((base & 0xff00) != (target & 0xff00)) {
+            target = (target & 0xff) | (val << 8);
+        }
+        write_cpu_bus(cpu->bus, target, val);
+        tick_cpu(cpu);
+    } break;
+    case OP_LAS: {
+        unsigned char val = read_cpu_bus(cpu->bus, operand) & cpu->s;
+        cpu->a = val;
+        cpu->x = val;
+        cpu->s = val;
+        cpu->status.z = val == 0;
+        cpu->status.n = val & 0x80;
+        tick_cpu(cpu);
+    } break;
     case OP_CLI:
         cpu->status.i = false;
         tick_cpu(cpu);
         break;
     case OP_BRK: {
+        poll_ppu_cpu_bus(cpu->bus);
         bool software_interrupt = !get_irq_interrupt(cpu->interrupt) &&
                                   !get_nmi_interrupt(cpu->interrupt) &&
                                   !get_reset_interrupt(cpu->interrupt);
@@ -1007,10 +1027,11 @@ bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
         cpu->status.b = software_interrupt;
         push_stack_cpu(cpu, get_status_cpu(cpu));
         cpu->status.b = false;
-        cpu->status.i = !get_nmi_interrupt(cpu->interrupt);
+        cpu->status.i = true;
         tick_cpu(cpu);
 
         // Determine target interrupt vector
+        poll_ppu_cpu_bus(cpu->bus);
         address_t interrupt_vector = CPU_VEC_IRQ_BRK;
         if (get_nmi_interrupt(cpu->interrupt)) {
             interrupt_vector = CPU_VEC_NMI;
@@ -1024,9 +1045,18 @@ bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
         unsigned char pch = read_cpu_bus(cpu->bus, interrupt_vector + 1);
         cpu->pc = (pch << 8) | pcl;
         tick_cpu(cpu);
+        if (cpu->callgraph) {
+            enter_callgraph(cpu->callgraph,
+                            cpu->pc,
+                            interrupt_vector,
+                            cpu->s,
+                            cpu->cycles);
+        }
 
-        // Reset interrupt signals
-        reset_interrupt(cpu->interrupt);
+        // Reset the edge-triggered signals, IRQ stays asserted by its source
+        poll_ppu_cpu_bus(cpu->bus);
+        set_nmi_interrupt(cpu->interrupt, false);
+        set_reset_interrupt(cpu->interrupt, false);
     } break;
     default:
         printf("Unimplemented opcode 0x%02X\n", opcode);
@@ -1036,13 +1066,41 @@ bool execute_op_cpu(cpu_t *cpu, unsigned char opcode, address_t operand) {
     return true;
 }
 
+// Each handler fuses the decode and execute stages of a single opcode. Since
+// the operation is a compile-time constant, the switches on the mnemonic and
+// addressing mode fold away and only the relevant bus cycles remain.
+#define CPU_HANDLER(opcode)                                                    \
+    static bool handler_##opcode##_cpu(cpu_t *cpu) {                           \
+        address_t operand = decode_op_cpu(cpu, OP_TABLE[opcode]);              \
+        return execute_op_cpu(cpu, opcode, OP_TABLE[opcode], operand);         \
+    }
+#define CPU_HANDLER_ENTRY(opcode) handler_##opcode##_cpu,
+
+OP_FOREACH(CPU_HANDLER)
+
+/**
+ * @brief Dispatch table of opcode handlers.
+ *
+ */
+static const cpu_handler_t CPU_HANDLERS[0x100] = {
+    OP_FOREACH(CPU_HANDLER_ENTRY)};
+
 bool update_cpu(cpu_t *cpu) {
+#ifdef NESC_PROFILE
+    unsigned long cycles = cpu->cycles;
+#endif
+
+    // Record the state before the instruction
+    if (cpu->trace) {
+        read_entry_cpu(cpu, push_trace(cpu->trace));
+    }
+
     // Fetch
     unsigned char opcode = fetch_op_cpu(cpu);
+    cpu->instructions++;
 
-    // Decode
-    address_t operand = decode_op_cpu(cpu, opcode);
-
-    // Execute
-    return execute_op_cpu(cpu, opcode, operand);
+    // Decode and execute
+    bool state = CPU_HANDLERS[opcode](cpu);
+    PROFILE_OP(&cpu->bus->profile, opcode, cpu->cycles - cycles);
+    return state;
 }
\ No newline at end of file
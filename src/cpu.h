@@ -2,17 +2,26 @@
 #define CPU_H
 
 #include "./apu.h"
+#include "./callgraph.h"
 #include "./cpu_bus.h"
 #include "./interrupt.h"
 #include "./memory.h"
 #include "./ops.h"
 #include "./ppu.h"
+#include "./trace.h"
 
 // Interrupt vector positions
 #define CPU_VEC_NMI     0xfffa
 #define CPU_VEC_RESET   0xfffc
 #define CPU_VEC_IRQ_BRK 0xfffe
 
+// Force inlining of the decode and execute stages into the opcode handlers
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_INLINE static inline __attribute__((always_inline))
+#else
+#define CPU_INLINE static inline
+#endif
+
 /**
  * @brief CPU status flags.
  *
@@ -68,6 +77,18 @@ typedef struct {
      */
     unsigned long cycles;
 
+    /**
+     * @brief Number of instructions executed.
+     *
+     */
+    unsigned long instructions;
+
+    /**
+     * @brief NMI assertion flag to delay until next instruction.
+     *
+     */
+    bool nmi_assert;
+
     /**
      * @brief Pointer to the CPU bus.
      *
@@ -81,12 +102,24 @@ typedef struct {
     interrupt_t *interrupt;
 
     /**
-     * @brief NMI assertion flag to delay until next instruction.
+     * @brief Optional subroutine profiler, NULL when disabled.
      *
      */
-    bool nmi_assert;
+    callgraph_t *callgraph;
+
+    /**
+     * @brief Optional instruction trace ring, NULL when disabled.
+     *
+     */
+    trace_t *trace;
 } cpu_t;
 
+/**
+ * @brief Handler that decodes and executes a single opcode.
+ *
+ */
+typedef bool (*cpu_handler_t)(cpu_t *cpu);
+
 /**
  * @brief Create the CPU.
  *
@@ -127,6 +160,15 @@ void push_stack_cpu(cpu_t *cpu, unsigned char value);
  */
 unsigned char pop_stack_cpu(cpu_t *cpu);
 
+/**
+ * @brief Capture the current state of the CPU into a trace entry without
+ * bus side effects.
+ *
+ * @param cpu
+ * @param entry
+ */
+void read_entry_cpu(cpu_t *cpu, trace_entry_t *entry);
+
 /**
  * @brief Read the current state of the CPU for debugging.
  *
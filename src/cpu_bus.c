@@ -12,6 +12,24 @@ void create_cpu_bus(cpu_bus_t *bus,
     bus->ppu = ppu;
     bus->controller = controller;
     memset(bus->memory, 0, CPU_RAM_SIZE);
+    bus->databus = 0;
+#ifdef NESC_PROFILE
+    clear_profile(&bus->profile);
+#endif
+
+    // Map internal RAM (and its mirrors) and the cartridge
+    clear_memory_map(&bus->map);
+    map_memory(&bus->map,
+               CPU_MAP_START,
+               CPU_MAP_PPU_REG - CPU_MAP_START,
+               bus->memory,
+               CPU_RAM_SIZE,
+               true);
+    map_cpu_mapper(mapper, &bus->map);
+
+    // Start the master clock in lockstep with the PPU
+    bus->clock = ppu->cycles;
+    bus->ppu_deadline = get_deadline_ppu(ppu);
 }
 
 address_t mirror_cpu_bus(address_t address) {
@@ -34,7 +52,7 @@ void oamdma_cpu_bus(cpu_bus_t *bus, unsigned char value) {
     }
 }
 
-unsigned char read_cpu_bus(cpu_bus_t *bus, address_t address) {
+unsigned char read_io_cpu_bus(cpu_bus_t *bus, address_t address) {
     if (address >= CPU_MAP_CARTRIDGE) {
         return read_cpu_mapper(bus->mapper, address);
     } else {
@@ -54,17 +72,20 @@ unsigned char read_cpu_bus(cpu_bus_t *bus, address_t address) {
         case PPU_REG_OAMDMA:
             return bus->ppu->io_databus;
         case CTRL_REG_JOYPAD1:
-            return read_joy1_controller(bus->controller);
+            return (bus->databus & 0xE0) |
+                   read_joy1_controller(bus->controller);
         case CTRL_REG_JOYPAD2:
-            return read_joy2_controller(bus->controller);
-        // TODO: Handle APU registers
+            return (bus->databus & 0xE0) |
+                   read_joy2_controller(bus->controller);
+        case APU_REG_STATUS:
+            return read_status_apu(bus->apu) | (bus->databus & 0x20);
         default:
-            return bus->memory[address];
+            return bus->databus;
         }
     }
 }
 
-void write_cpu_bus(cpu_bus_t *bus, address_t address, unsigned char value) {
+void write_io_cpu_bus(cpu_bus_t *bus, address_t address, unsigned char value) {
     if (address >= CPU_MAP_CARTRIDGE) {
         write_cpu_mapper(bus->mapper, address, value);
     } else {
@@ -99,14 +120,74 @@ void write_cpu_bus(cpu_bus_t *bus, address_t address, unsigned char value) {
         case CTRL_REG_JOYPAD1:
             write_strobe_controller(bus->controller, value);
             break;
-        // TODO: Handle APU registers
         default:
-            bus->memory[address] = value;
+            write_register_apu(bus->apu, address, value);
             break;
         }
     }
 }
 
+bool is_ppu_io_cpu_bus(address_t address, bool write) {
+    // Mapper writes may switch the banks seen by the PPU
+    if (write && (address == PPU_REG_OAMDMA || address >= CPU_MAP_CARTRIDGE)) {
+        return true;
+    }
+    return address >= CPU_MAP_PPU_REG && address < CPU_MAP_APU_IO;
+}
+
+void sync_ppu_cpu_bus(cpu_bus_t *bus) {
+    run_ppu(bus->ppu, bus->clock);
+    bus->ppu_deadline = get_deadline_ppu(bus->ppu);
+}
+
+void poll_ppu_cpu_bus(cpu_bus_t *bus) {
+    if (bus->clock > bus->ppu_deadline) {
+        sync_ppu_cpu_bus(bus);
+    }
+}
+
+unsigned char read_cpu_bus(cpu_bus_t *bus, address_t address) {
+    PROFILE_READ(&bus->profile, address);
+    unsigned char *page = bus->map.read[address / MEMORY_PAGE_SIZE];
+    if (page) {
+        bus->databus = page[address % MEMORY_PAGE_SIZE];
+    } else if (!is_ppu_io_cpu_bus(address, false)) {
+        bus->databus = read_io_cpu_bus(bus, address);
+    } else {
+        // Register accesses observe the PPU at the current master clock and
+        // may change when it next raises or drops NMI
+        sync_ppu_cpu_bus(bus);
+        bus->databus = read_io_cpu_bus(bus, address);
+        bus->ppu_deadline = get_deadline_ppu(bus->ppu);
+    }
+    return bus->databus;
+}
+
+unsigned char peek_cpu_bus(cpu_bus_t *bus, address_t address) {
+    unsigned char *page = bus->map.read[address / MEMORY_PAGE_SIZE];
+    if (page) {
+        return page[address % MEMORY_PAGE_SIZE];
+    } else if (address >= CPU_MAP_CARTRIDGE) {
+        return read_cpu_mapper(bus->mapper, address);
+    }
+    return bus->databus;
+}
+
+void write_cpu_bus(cpu_bus_t *bus, address_t address, unsigned char value) {
+    PROFILE_WRITE(&bus->profile, address);
+    unsigned char *page = bus->map.write[address / MEMORY_PAGE_SIZE];
+    bus->databus = value;
+    if (page) {
+        page[address % MEMORY_PAGE_SIZE] = value;
+    } else if (!is_ppu_io_cpu_bus(address, true)) {
+        write_io_cpu_bus(bus, address, value);
+    } else {
+        sync_ppu_cpu_bus(bus);
+        write_io_cpu_bus(bus, address, value);
+        bus->ppu_deadline = get_deadline_ppu(bus->ppu);
+    }
+}
+
 unsigned
 read_string_cpu_bus(cpu_bus_t *bus, address_t address, char *dst, unsigned n) {
     char c = read_cpu_bus(bus, address);
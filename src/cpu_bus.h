@@ -5,10 +5,11 @@
 #include "./controller.h"
 #include "./mapper.h"
 #include "./ppu.h"
+#include "./profile.h"
 #include "./rom.h"
 
-// 6502 has a 16-bit address bus (64k)
-#define CPU_RAM_SIZE (1 << 16)
+// 2k of internal RAM, mirrored up to the PPU registers
+#define CPU_RAM_SIZE 0x800
 
 // CPU memory map address offsets
 #define CPU_MAP_START        0x0000
@@ -69,16 +70,36 @@
  */
 typedef struct {
     /**
-     * @brief CPU memory address space.
+     * @brief Internal RAM.
      *
      */
     unsigned char memory[CPU_RAM_SIZE];
 
     /**
-     * @brief Internal buffer for reading from PPU data register.
+     * @brief Last value driven on the data bus, returned when reading
+     * addresses that nothing responds to (open bus).
      *
      */
-    unsigned char buffer2007;
+    unsigned char databus;
+
+    /**
+     * @brief Page table for direct access to RAM and cartridge memory.
+     *
+     */
+    memory_map_t map;
+
+    /**
+     * @brief Master clock reached by the CPU, measured in PPU cycles.
+     *
+     */
+    unsigned long clock;
+
+    /**
+     * @brief PPU cycle that must be reached before the CPU can observe the PPU
+     * changing state on its own.
+     *
+     */
+    unsigned long ppu_deadline;
 
     /**
      * @brief Pointer to the ROM.
@@ -109,6 +130,14 @@ typedef struct {
      *
      */
     controller_t *controller;
+
+#ifdef NESC_PROFILE
+    /**
+     * @brief Execution counters.
+     *
+     */
+    profile_t profile;
+#endif
 } cpu_bus_t;
 
 /**
@@ -145,6 +174,16 @@ address_t mirror_cpu_bus(address_t address);
  */
 unsigned char read_cpu_bus(cpu_bus_t *bus, address_t address);
 
+/**
+ * @brief Read a byte from memory or the cartridge without any side effects,
+ * for debugging. Registers read as the open bus value.
+ *
+ * @param bus
+ * @param address
+ * @return unsigned char
+ */
+unsigned char peek_cpu_bus(cpu_bus_t *bus, address_t address);
+
 /**
  * @brief Write a byte to the CPU's memory map.
  *
@@ -154,6 +193,21 @@ unsigned char read_cpu_bus(cpu_bus_t *bus, address_t address);
  */
 void write_cpu_bus(cpu_bus_t *bus, address_t address, unsigned char value);
 
+/**
+ * @brief Catch the PPU up to the master clock.
+ *
+ * @param bus
+ */
+void sync_ppu_cpu_bus(cpu_bus_t *bus);
+
+/**
+ * @brief Catch the PPU up to the master clock only if it has passed the PPU
+ * deadline.
+ *
+ * @param bus
+ */
+void poll_ppu_cpu_bus(cpu_bus_t *bus);
+
 /**
  * @brief Read a string from the CPU bus.
  *
@@ -1,10 +1,34 @@
 #include "./emulator.h"
 
-void create_emulator(emulator_t *emu, const char *rom_path) {
-    load_rom(&emu->rom, rom_path);
+// Byte range [first, last] of the emulator structure
+#define STATE_SECTION(first, last)                                            \
+    {                                                                          \
+        offsetof(emulator_t, first),                                           \
+            offsetof(emulator_t, last) + sizeof(((emulator_t *)0)->last) -     \
+                offsetof(emulator_t, first),                                   \
+    }
+
+// Pointer-free state saved in order, followed by the cartridge RAM
+static const emulator_state_section_t EMULATOR_STATE_SECTIONS[] = {
+    STATE_SECTION(cpu.a, cpu.nmi_assert),
+    STATE_SECTION(apu.pulse, apu.cycles),
+    STATE_SECTION(ppu.ctrl, ppu.frames),
+    STATE_SECTION(controller, controller),
+    STATE_SECTION(cpu_bus.memory, cpu_bus.databus),
+    STATE_SECTION(cpu_bus.clock, cpu_bus.clock),
+    STATE_SECTION(ppu_bus.memory[PPU_MAP_NAMETABLE_0],
+                  ppu_bus.memory[PPU_MAP_NAMETABLE_MIRROR - 1]),
+    STATE_SECTION(interrupt, interrupt),
+    STATE_SECTION(mapper.state, mapper.state),
+};
+
+#define STATE_SECTION_COUNT                                                   \
+    (sizeof(EMULATOR_STATE_SECTIONS) / sizeof(EMULATOR_STATE_SECTIONS[0]))
+
+void boot_emulator(emulator_t *emu) {
     create_mapper(&emu->mapper, &emu->rom);
     create_cpu(&emu->cpu, &emu->cpu_bus, &emu->interrupt);
-    create_apu(&emu->apu, &emu->interrupt);
+    create_apu(&emu->apu, &emu->mapper, &emu->interrupt);
     create_ppu(&emu->ppu, &emu->ppu_bus, &emu->interrupt);
     create_controller(&emu->controller);
     create_cpu_bus(&emu->cpu_bus,
@@ -16,16 +40,22 @@ void create_emulator(emulator_t *emu, const char *rom_path) {
     create_ppu_bus(&emu->ppu_bus, &emu->rom, &emu->mapper);
     reset_interrupt(&emu->interrupt);
 
-    // Initialize frame counter variables
-    emu->cycle_accumulator = 0;
-    emu->frames = 0;
-
     // Set the program counter
     unsigned char pcl = read_cpu_bus(&emu->cpu_bus, CPU_VEC_RESET);
     unsigned char pch = read_cpu_bus(&emu->cpu_bus, CPU_VEC_RESET + 1);
     emu->cpu.pc = (pch << 8) | pcl;
 }
 
+void create_emulator(emulator_t *emu, const char *rom_path) {
+    load_rom(&emu->rom, rom_path);
+    boot_emulator(emu);
+}
+
+void create_rom_emulator(emulator_t *emu, const rom_t *rom) {
+    copy_rom(&emu->rom, rom);
+    boot_emulator(emu);
+}
+
 void destroy_emulator(emulator_t *emu) {
     destroy_cpu(&emu->cpu);
     destroy_apu(&emu->apu);
@@ -35,17 +65,117 @@ void destroy_emulator(emulator_t *emu) {
     unload_rom(&emu->rom);
 }
 
-bool update_emulator(emulator_t *emu) {
-    // Update the CPU (and its peripherals)
-    unsigned prev_cycles = emu->cpu.cycles;
-    bool cpu_state = update_cpu(&emu->cpu);
-    unsigned delta_cycles = emu->cpu.cycles - prev_cycles;
+bool update_emulator(emulator_t *emu) { return update_cpu(&emu->cpu); }
+
+emulator_status_t run_frame_emulator(emulator_t *emu) {
+    // The frame counter advances when the PPU catches up past the wrap
+    unsigned long frame = emu->ppu.frames;
+    emulator_status_t status = EMULATOR_FRAME;
+    while (emu->ppu.frames == frame) {
+        if (!update_cpu(&emu->cpu)) {
+            status = EMULATOR_HALT;
+            break;
+        }
+    }
+    sync_ppu_cpu_bus(&emu->cpu_bus);
+    return status;
+}
+
+emulator_status_t run_cycles_emulator(emulator_t *emu, unsigned long cycles) {
+    unsigned long target = emu->cpu.cycles + cycles;
+    emulator_status_t status = EMULATOR_CYCLES;
+    while (emu->cpu.cycles < target) {
+        if (!update_cpu(&emu->cpu)) {
+            status = EMULATOR_HALT;
+            break;
+        }
+    }
+    sync_ppu_cpu_bus(&emu->cpu_bus);
+    return status;
+}
+
+emulator_status_t run_until_emulator(emulator_t *emu,
+                                     emulator_predicate_t predicate,
+                                     void *data) {
+    // The PPU otherwise only catches up at its deadlines and register accesses
+    do {
+        if (!update_cpu(&emu->cpu)) {
+            sync_ppu_cpu_bus(&emu->cpu_bus);
+            return EMULATOR_HALT;
+        }
+        sync_ppu_cpu_bus(&emu->cpu_bus);
+    } while (!predicate(emu, data));
+    return EMULATOR_PREDICATE;
+}
 
-    // Update frame counter
-    emu->cycle_accumulator += delta_cycles;
-    if (3 * emu->cycle_accumulator >= PPU_LINEDOTS * PPU_SCANLINES) {
-        emu->cycle_accumulator = 0;
-        emu->frames++;
+unsigned long get_state_size_emulator(emulator_t *emu) {
+    unsigned long size = sizeof(emulator_state_header_t);
+    for (unsigned i = 0; i < STATE_SECTION_COUNT; i++) {
+        size += EMULATOR_STATE_SECTIONS[i].size;
     }
-    return cpu_state;
+    return size + emu->rom.header.prg_ram_size + emu->rom.header.chr_ram_size;
+}
+
+unsigned long save_state_emulator(emulator_t *emu,
+                                  unsigned char *buffer,
+                                  unsigned long size) {
+    emulator_state_header_t header;
+    memcpy(header.magic, EMULATOR_STATE_MAGIC, sizeof(header.magic));
+    header.version = EMULATOR_STATE_VERSION;
+    header.size = get_state_size_emulator(emu);
+    if (size < header.size) {
+        return 0;
+    }
+
+    unsigned char *dst = buffer;
+    memcpy(dst, &header, sizeof(header));
+    dst += sizeof(header);
+    for (unsigned i = 0; i < STATE_SECTION_COUNT; i++) {
+        emulator_state_section_t section = EMULATOR_STATE_SECTIONS[i];
+        memcpy(dst, (unsigned char *)emu + section.offset, section.size);
+        dst += section.size;
+    }
+
+    // Cartridge RAM
+    memcpy(dst, get_prg_ram(&emu->rom), emu->rom.header.prg_ram_size);
+    dst += emu->rom.header.prg_ram_size;
+    memcpy(dst, get_chr_ram(&emu->rom), emu->rom.header.chr_ram_size);
+    return header.size;
 }
+
+bool load_state_emulator(emulator_t *emu,
+                         const unsigned char *buffer,
+                         unsigned long size) {
+    emulator_state_header_t header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, buffer, sizeof(header));
+    if (memcmp(header.magic, EMULATOR_STATE_MAGIC, sizeof(header.magic)) ||
+        header.version != EMULATOR_STATE_VERSION ||
+        header.size != get_state_size_emulator(emu) || size < header.size) {
+        return false;
+    }
+
+    const unsigned char *src = buffer + sizeof(header);
+    for (unsigned i = 0; i < STATE_SECTION_COUNT; i++) {
+        emulator_state_section_t section = EMULATOR_STATE_SECTIONS[i];
+        memcpy((unsigned char *)emu + section.offset, src, section.size);
+        src += section.size;
+    }
+
+    // Cartridge RAM
+    memcpy(get_prg_ram(&emu->rom), src, emu->rom.header.prg_ram_size);
+    src += emu->rom.header.prg_ram_size;
+    memcpy(get_chr_ram(&emu->rom), src, emu->rom.header.chr_ram_size);
+
+    // Rebuild the derived bus state for the restored banks and timing
+    map_cpu_mapper(&emu->mapper, &emu->cpu_bus.map);
+    emu->cpu_bus.ppu_deadline = get_deadline_ppu(&emu->ppu);
+
+    // Time moved, possibly backwards, so the profiler must not charge the gap
+    if (emu->cpu.callgraph) {
+        resync_callgraph(emu->cpu.callgraph, emu->cpu.s, emu->cpu.cycles);
+    }
+    return true;
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef EMULATOR_H
 #define EMULATOR_H
 
+#include <stddef.h>
+
 #include "./apu.h"
 #include "./controller.h"
 #include "./cpu.h"
@@ -11,6 +13,21 @@
 #include "./ppu_bus.h"
 #include "./rom.h"
 
+// Save state blob identification
+#define EMULATOR_STATE_MAGIC   "NESS"
+#define EMULATOR_STATE_VERSION 4
+
+/**
+ * @brief Reason a run loop returned control to the caller.
+ *
+ */
+typedef enum {
+    EMULATOR_FRAME,
+    EMULATOR_CYCLES,
+    EMULATOR_PREDICATE,
+    EMULATOR_HALT,
+} emulator_status_t;
+
 /**
  * @brief Emulator structure holding all its subsystems.
  *
@@ -69,19 +86,56 @@ typedef struct {
      *
      */
     interrupt_t interrupt;
+} emulator_t;
+
+/**
+ * @brief Save state blob header.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Identifies the blob as a save state.
+     *
+     */
+    char magic[4];
 
     /**
-     * @brief Accumulator for frame-counting.
+     * @brief Layout version, bumped whenever the saved sections change.
      *
      */
-    unsigned cycle_accumulator;
+    unsigned version;
 
     /**
-     * @brief Frame counter.
+     * @brief Total size of the blob including this header.
      *
      */
-    unsigned frames;
-} emulator_t;
+    unsigned long size;
+} emulator_state_header_t;
+
+/**
+ * @brief Byte range of the emulator structure copied into a save state.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Offset into emulator_t.
+     *
+     */
+    unsigned long offset;
+
+    /**
+     * @brief Length in bytes.
+     *
+     */
+    unsigned long size;
+} emulator_state_section_t;
+
+/**
+ * @brief Stop condition for run_until_emulator(), checked after every
+ * instruction with the PPU caught up to the CPU.
+ *
+ */
+typedef bool (*emulator_predicate_t)(emulator_t *emu, void *data);
 
 /**
  * @brief Create an emulator.
@@ -91,6 +145,14 @@ typedef struct {
  */
 void create_emulator(emulator_t *emu, const char *rom_path);
 
+/**
+ * @brief Create an emulator sharing the image of a loaded ROM.
+ *
+ * @param emu
+ * @param rom
+ */
+void create_rom_emulator(emulator_t *emu, const rom_t *rom);
+
 /**
  * @brief Free all resources held by the emulator.
  *
@@ -99,7 +161,7 @@ void create_emulator(emulator_t *emu, const char *rom_path);
 void destroy_emulator(emulator_t *emu);
 
 /**
- * @brief Update the emulator.
+ * @brief Update the emulator by a single CPU instruction.
  *
  * @param emu
  * @return true
@@ -107,4 +169,72 @@ void destroy_emulator(emulator_t *emu);
  */
 bool update_emulator(emulator_t *emu);
 
+/**
+ * @brief Run the emulator until the PPU wraps to the next frame, returning
+ * with the PPU caught up to the CPU.
+ *
+ * @param emu
+ * @return emulator_status_t
+ */
+emulator_status_t run_frame_emulator(emulator_t *emu);
+
+/**
+ * @brief Run the emulator for at least the given number of CPU cycles,
+ * stopping on the first instruction boundary past the target with the PPU
+ * caught up to the CPU.
+ *
+ * @param emu
+ * @param cycles
+ * @return emulator_status_t
+ */
+emulator_status_t run_cycles_emulator(emulator_t *emu, unsigned long cycles);
+
+/**
+ * @brief Run the emulator until the predicate holds.
+ *
+ * @param emu
+ * @param predicate
+ * @param data User data passed to the predicate
+ * @return emulator_status_t
+ */
+emulator_status_t run_until_emulator(emulator_t *emu,
+                                     emulator_predicate_t predicate,
+                                     void *data);
+
+/**
+ * @brief Get the size of a save state blob for the loaded cartridge.
+ *
+ * @param emu
+ * @return unsigned long
+ */
+unsigned long get_state_size_emulator(emulator_t *emu);
+
+/**
+ * @brief Write a save state of the emulator.
+ *
+ * The blob holds no pointers and is only valid for the same cartridge and
+ * build of the emulator.
+ *
+ * @param emu
+ * @param buffer
+ * @param size Capacity of the buffer
+ * @return unsigned long Bytes written, or 0 if the buffer is too small
+ */
+unsigned long save_state_emulator(emulator_t *emu,
+                                  unsigned char *buffer,
+                                  unsigned long size);
+
+/**
+ * @brief Restore a save state of the emulator.
+ *
+ * @param emu
+ * @param buffer
+ * @param size
+ * @return true
+ * @return false The blob is malformed or from another version or cartridge
+ */
+bool load_state_emulator(emulator_t *emu,
+                         const unsigned char *buffer,
+                         unsigned long size);
+
 #endif
\ No newline at end of file
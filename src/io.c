@@ -1,9 +1,11 @@
 #include "./io.h"
 
 void create_io(io_t *io, emulator_t *emu) {
-    io->emu = emu;
-    create_display(&io->display, 256, 240, "NES-C");
+    create_color_table(io->color_table);
+    create_display(&io->display, PPU_SCREEN_WIDTH, PPU_SCREEN_HEIGHT, "NES-C");
     create_audio(&io->audio, &emu->apu.buffer);
+    set_rate_apu(&emu->apu, io->audio.spec.freq, true);
+    play_audio(&io->audio);
     create_input(&io->input);
 }
 
@@ -26,17 +28,35 @@ bool is_debug_io(io_t *io) {
 void set_debug_io(io_t *io, bool debug) {
     if (is_debug_io(io) == debug) return;
     if (debug) {
-        create_display(&io->pattern_table, 128, 256, "Pattern Tables");
-        create_display(&io->nametables, 32 * 2 * 8, 30 * 2 * 8, "Nametables");
+        create_display(&io->pattern_table,
+                       IO_PATTERN_TABLE_WIDTH,
+                       IO_PATTERN_TABLE_HEIGHT,
+                       "Pattern Tables");
+        create_display(&io->nametables,
+                       IO_NAMETABLES_WIDTH,
+                       IO_NAMETABLES_HEIGHT,
+                       "Nametables");
     } else {
         destroy_display(&io->pattern_table);
         destroy_display(&io->nametables);
     }
 }
 
-void debug_io(io_t *io, emulator_t *emu) {
-    unsigned char *chr_rom = get_chr_rom(&emu->rom);
-    ppu_t *ppu = &io->emu->ppu;
+void render_io(io_t *io, emulator_t *emu, unsigned char *pixels) {
+    unsigned *rgb = (unsigned *)pixels;
+    for (unsigned i = 0; i < PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT; i++) {
+        color_t color = io->color_table[emu->ppu.color_buffer[i]];
+        rgb[i] = color.r << 16 | color.g << 8 | color.b;
+    }
+}
+
+void render_debug_io(io_t *io, emulator_t *emu, unsigned char *pixels) {
+    unsigned char *chr_rom = get_chr_memory_rom(&emu->rom);
+    ppu_t *ppu = &emu->ppu;
+    unsigned *screen = (unsigned *)pixels;
+    unsigned *pattern_table = (unsigned *)(pixels + IO_SCREEN_SIZE);
+    unsigned *nametables =
+        (unsigned *)(pixels + IO_SCREEN_SIZE + IO_PATTERN_TABLE_SIZE);
     address_t nt_bases[4] = {
         0x2000,
         0x2400,
@@ -45,12 +65,11 @@ void debug_io(io_t *io, emulator_t *emu) {
     };
 
     // Draw tile grid
-    const color_t grid_color = {0xff, 0, 0};
-    for (unsigned x = 0; x < io->display.size.x; x++) {
-        for (unsigned y = 0; y < io->display.size.y; y++) {
+    const unsigned grid_color = 0xff << 16;
+    for (unsigned x = 0; x < PPU_SCREEN_WIDTH; x++) {
+        for (unsigned y = 0; y < PPU_SCREEN_HEIGHT; y++) {
             if (x % 8 == 0 || y % 8 == 0) {
-                vec2_t position = {x, y};
-                draw_display(&io->display, position, grid_color);
+                screen[y * PPU_SCREEN_WIDTH + x] = grid_color;
             }
         }
     }
@@ -60,24 +79,18 @@ void debug_io(io_t *io, emulator_t *emu) {
         for (unsigned y = 0; y < 8; y++) {
             unsigned char plane0 = chr_rom[i * 16 + y];
             unsigned char plane1 = chr_rom[i * 16 + y + 8];
+            unsigned char tile_pixels[8];
+            decode_row_tile(plane0, plane1, 0, tile_pixels);
 
             for (unsigned x = 0; x < 8; x++) {
-                unsigned char pixel = ((plane0 >> (7 - x)) & 1) |
-                                      (((plane1 >> (7 - x)) & 1) << 1);
-                vec2_t position = {
-                    (i & 15) * 8 + x,
-                    (i >> 4) * 8 + y,
-                };
-                color_t color = create_color(ppu->palette[pixel],
-                                             false,
-                                             false,
-                                             false,
-                                             false);
-                draw_display(&io->pattern_table, position, color);
+                unsigned px = (i & 15) * 8 + x;
+                unsigned py = (i >> 4) * 8 + y;
+                color_t color = io->color_table[ppu->palette[tile_pixels[x]]];
+                pattern_table[py * IO_PATTERN_TABLE_WIDTH + px] =
+                    color.r << 16 | color.g << 8 | color.b;
             }
         }
     }
-    refresh_display(&io->pattern_table);
 
     // Draw nametables
     for (unsigned b = 0; b < 0x3C0; b++) {
@@ -101,42 +114,36 @@ void debug_io(io_t *io, emulator_t *emu) {
                 address_t pt_address = (bg_ctrl * 0x1000) | (tile << 4) | y;
                 unsigned char lo = read_ppu_bus(ppu->bus, pt_address);
                 unsigned char hi = read_ppu_bus(ppu->bus, pt_address + 8);
+                unsigned char tile_pixels[8];
+                decode_row_tile(lo, hi, palette, tile_pixels);
 
                 for (unsigned x = 0; x < 8; x++) {
-                    unsigned char palette_index = (palette << 2) |
-                                                  ((lo >> (7 - x)) & 1) |
-                                                  (((hi >> (7 - x)) & 1) << 1);
-                    vec2_t position = {
-                        x_tile_offset * 8 + x,
-                        y_tile_offset * 8 + y,
-                    };
-                    color_t color = create_color(ppu->palette[palette_index],
-                                                 false,
-                                                 false,
-                                                 false,
-                                                 false);
-                    draw_display(&io->nametables, position, color);
+                    unsigned px = x_tile_offset * 8 + x;
+                    unsigned py = y_tile_offset * 8 + y;
+                    color_t color =
+                        io->color_table[ppu->palette[tile_pixels[x]]];
+                    nametables[py * IO_NAMETABLES_WIDTH + px] =
+                        color.r << 16 | color.g << 8 | color.b;
                 }
             }
         }
     }
-    refresh_display(&io->nametables);
 }
 
-bool refresh_io(io_t *io, emulator_t *emu) {
+bool refresh_io(io_t *io, unsigned char *pixels) {
     poll_input(&io->input);
 
-    // Draw the color buffer from the PPU.
-    for (unsigned x = 0; x < io->display.size.x; x++) {
-        for (unsigned y = 0; y < io->display.size.y; y++) {
-            unsigned i = x + y * PPU_LINEDOTS;
-            vec2_t position = {x, y};
-            color_t color = emu->ppu.color_buffer[i];
-            draw_display(&io->display, position, color);
-        }
-    }
+    // Upload the rendered frame and its debug views
+    memcpy(io->display.bitmap.buffer, pixels, IO_SCREEN_SIZE);
     if (is_debug_io(io)) {
-        debug_io(io, emu);
+        memcpy(io->pattern_table.bitmap.buffer,
+               pixels + IO_SCREEN_SIZE,
+               IO_PATTERN_TABLE_SIZE);
+        refresh_display(&io->pattern_table);
+        memcpy(io->nametables.bitmap.buffer,
+               pixels + IO_SCREEN_SIZE + IO_PATTERN_TABLE_SIZE,
+               IO_NAMETABLES_SIZE);
+        refresh_display(&io->nametables);
     }
 
     refresh_display(&io->display);
@@ -6,17 +6,26 @@
 #include "./emulator.h"
 #include "./input.h"
 
+// Debug views of the two pattern tables and the four nametables
+#define IO_PATTERN_TABLE_WIDTH  128
+#define IO_PATTERN_TABLE_HEIGHT 256
+#define IO_NAMETABLES_WIDTH     (32 * 2 * 8)
+#define IO_NAMETABLES_HEIGHT    (30 * 2 * 8)
+
+// Planes of a rendered frame in 32-bit RGB pixels, the screen followed by the
+// debug views
+#define IO_SCREEN_SIZE (PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT * 4)
+#define IO_PATTERN_TABLE_SIZE \
+    (IO_PATTERN_TABLE_WIDTH * IO_PATTERN_TABLE_HEIGHT * 4)
+#define IO_NAMETABLES_SIZE (IO_NAMETABLES_WIDTH * IO_NAMETABLES_HEIGHT * 4)
+#define IO_FRAME_SIZE \
+    (IO_SCREEN_SIZE + IO_PATTERN_TABLE_SIZE + IO_NAMETABLES_SIZE)
+
 /**
  * @brief Device subsystems for simulating I/O hardware.
  *
  */
 typedef struct {
-    /**
-     * @brief Logical emulator.
-     *
-     */
-    emulator_t *emu;
-
     /**
      * @brief Main display.
      *
@@ -35,6 +44,12 @@ typedef struct {
      */
     input_t input;
 
+    /**
+     * @brief Look-up table for converting PPU color indices to RGB.
+     *
+     */
+    color_t color_table[COLOR_TABLE_SIZE];
+
     /**
      * @brief Pattern table display (debug only).
      *
@@ -81,13 +96,35 @@ void set_debug_io(io_t *io, bool debug);
 bool is_debug_io(io_t *io);
 
 /**
- * @brief Refresh the I/O interfaces.
+ * @brief Convert the completed PPU frame into the screen plane. Touches no SDL
+ * state, so it may run on the emulation thread.
  *
  * @param io
  * @param emu
+ * @param pixels Frame of IO_FRAME_SIZE bytes.
+ */
+void render_io(io_t *io, emulator_t *emu, unsigned char *pixels);
+
+/**
+ * @brief Draw the tile grid over the screen plane and render the pattern
+ * tables and nametables into the debug planes. Touches no SDL state, so it
+ * may run on the emulation thread.
+ *
+ * @param io
+ * @param emu
+ * @param pixels Frame of IO_FRAME_SIZE bytes, after render_io.
+ */
+void render_debug_io(io_t *io, emulator_t *emu, unsigned char *pixels);
+
+/**
+ * @brief Refresh the I/O interfaces, presenting a rendered frame and, in debug
+ * mode, its debug planes.
+ *
+ * @param io
+ * @param pixels Frame produced by render_io and render_debug_io.
  * @return true
  * @return false
  */
-bool refresh_io(io_t *io, emulator_t *emu);
+bool refresh_io(io_t *io, unsigned char *pixels);
 
 #endif
\ No newline at end of file
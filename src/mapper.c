@@ -29,6 +29,16 @@ void destroy_mapper(mapper_t *mapper) {
     }
 }
 
+void map_cpu_mapper(mapper_t *mapper, memory_map_t *map) {
+    switch (mapper->type) {
+    case MAPPER_NROM:
+        map_cpu_nrom(mapper->rom, map);
+        break;
+    default:
+        break;
+    }
+}
+
 unsigned char read_cpu_mapper(mapper_t *mapper, address_t address) {
     switch (mapper->type) {
     case MAPPER_NROM:
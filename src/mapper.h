@@ -57,6 +57,15 @@ void create_mapper(mapper_t *mapper, rom_t *rom);
  */
 void destroy_mapper(mapper_t *mapper);
 
+/**
+ * @brief Map the cartridge memory that can be accessed directly onto the CPU
+ * memory map.
+ *
+ * @param mapper
+ * @param map
+ */
+void map_cpu_mapper(mapper_t *mapper, memory_map_t *map);
+
 /**
  * @brief Read from a CPU mapper.
  *
@@ -1,5 +1,20 @@
 #include "./nrom.h"
 
+void map_cpu_nrom(rom_t *rom, memory_map_t *map) {
+    map_memory(map,
+               0x6000,
+               0x2000,
+               get_prg_ram(rom),
+               rom->header.prg_ram_size,
+               true);
+    map_memory(map,
+               0x8000,
+               0x8000,
+               get_prg_rom(rom),
+               rom->header.prg_rom_size,
+               false);
+}
+
 unsigned char read_cpu_nrom(rom_t *rom, address_t address) {
     if (address >= 0x8000) {
         address_t mask = rom->header.prg_rom_size - 1;
@@ -13,7 +28,7 @@ unsigned char read_cpu_nrom(rom_t *rom, address_t address) {
 }
 
 unsigned char read_ppu_nrom(rom_t *rom, address_t address) {
-    return get_chr_rom(rom)[address];
+    return get_chr_memory_rom(rom)[address];
 }
 
 void write_cpu_nrom(rom_t *rom, address_t address, unsigned char value) {
@@ -25,6 +40,6 @@ void write_cpu_nrom(rom_t *rom, address_t address, unsigned char value) {
 
 void write_ppu_nrom(rom_t *rom, address_t address, unsigned char value) {
     if (rom->header.chr_ram_size > 0) {
-        get_chr_rom(rom)[address] = value;
+        get_chr_ram(rom)[address] = value;
     }
 }
\ No newline at end of file
@@ -4,6 +4,14 @@
 #include "../memory.h"
 #include "../rom.h"
 
+/**
+ * @brief Map NROM PRG ROM and PRG RAM onto the CPU memory map.
+ *
+ * @param rom
+ * @param map
+ */
+void map_cpu_nrom(rom_t *rom, memory_map_t *map);
+
 /**
  * @brief Read from NROM CPU memory.
  *
@@ -18,4 +18,28 @@ void free_memory(memory_t *memory) {
     free(memory->buffer);
     memory->buffer = NULL;
     memory->size = 0;
+}
+
+void clear_memory_map(memory_map_t *map) {
+    for (unsigned i = 0; i < MEMORY_PAGE_COUNT; i++) {
+        map->read[i] = NULL;
+        map->write[i] = NULL;
+    }
+}
+
+void map_memory(memory_map_t *map,
+                address_t address,
+                unsigned long length,
+                unsigned char *buffer,
+                unsigned long size,
+                bool writable) {
+    unsigned long mask = size - 1;
+    for (unsigned long offset = 0; offset < length;
+         offset += MEMORY_PAGE_SIZE) {
+        unsigned long page_address = address + offset;
+        unsigned char *page = buffer + (page_address & mask);
+        unsigned page_index = page_address / MEMORY_PAGE_SIZE;
+        map->read[page_index] = page;
+        map->write[page_index] = writable ? page : NULL;
+    }
 }
\ No newline at end of file
@@ -29,6 +29,32 @@ typedef struct {
  */
 typedef unsigned short address_t;
 
+// Granularity of a memory map
+#define MEMORY_PAGE_SIZE  0x100
+#define MEMORY_PAGE_COUNT 0x100
+
+/**
+ * @brief Page table of host pointers covering a 16-bit address space.
+ *
+ * Each entry points to the 256 bytes backing a page. A NULL entry means the
+ * page has side effects (I/O registers, mapper ports) and accesses must go
+ * through the owner's handler instead.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Pages readable directly.
+     *
+     */
+    unsigned char *read[MEMORY_PAGE_COUNT];
+
+    /**
+     * @brief Pages writable directly.
+     *
+     */
+    unsigned char *write[MEMORY_PAGE_COUNT];
+} memory_map_t;
+
 /**
  * @brief Allocate memory.
  *
@@ -53,4 +79,30 @@ bool is_free_memory(memory_t *memory);
  */
 void free_memory(memory_t *memory);
 
+/**
+ * @brief Unmap every page of a memory map.
+ *
+ * @param map
+ */
+void clear_memory_map(memory_map_t *map);
+
+/**
+ * @brief Map an address range onto a host buffer. Pages are mirrored across
+ * the buffer, so the page at an address is backed by
+ * `buffer + (address & (size - 1))`.
+ *
+ * @param map
+ * @param address  Start of the range (page aligned).
+ * @param length   Length of the range in bytes (multiple of the page size).
+ * @param buffer   Backing buffer.
+ * @param size     Size of the backing buffer (power of 2).
+ * @param writable Also map the range for direct writes.
+ */
+void map_memory(memory_map_t *map,
+                address_t address,
+                unsigned long length,
+                unsigned char *buffer,
+                unsigned long size,
+                bool writable);
+
 #endif
\ No newline at end of file
@@ -1,6 +1,24 @@
 #include "./nes.h"
 
-void print_usage() { printf("Usage: nesc %s <input_file>\n", ARG_INPUT_FILE); }
+void print_usage() {
+    printf("Usage: nesc %s <input_file> [%s <palette_file>] "
+           "[%s <folded_stacks_file>] [%s <trace_file>] "
+           "[%s clock|audio|vsync]\n",
+           ARG_INPUT_FILE,
+           ARG_PALETTE_FILE,
+           ARG_CALLGRAPH_FILE,
+           ARG_TRACE_FILE,
+           ARG_PACING);
+}
+
+const char *get_flag_arg(int argc, char **argv, const char *flag) {
+    for (int i = 3; i < argc - 1; i++) {
+        if (strcmp(argv[i], flag) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return NULL;
+}
 
 void parse_args(emulator_t *emu, int argc, char **argv) {
     // Verify arguments
@@ -14,11 +32,84 @@ void parse_args(emulator_t *emu, int argc, char **argv) {
     }
 
     create_emulator(emu, argv[2]);
-    if (argc == 4) {
+    if (argc >= 4 && argv[3][0] != '-') {
         emu->cpu.pc = strtol(argv[3], NULL, 16);
     }
 }
 
+unsigned read_input_snapshot(io_t *io) {
+    unsigned input = 0;
+    input |= is_keydown_input(&io->input, SDLK_z) ? NES_INPUT_A : 0;
+    input |= is_keydown_input(&io->input, SDLK_x) ? NES_INPUT_B : 0;
+    input |= is_keydown_input(&io->input, SDLK_a) ? NES_INPUT_SELECT : 0;
+    input |= is_keydown_input(&io->input, SDLK_s) ? NES_INPUT_START : 0;
+    input |= is_keydown_input(&io->input, SDLK_UP) ? NES_INPUT_UP : 0;
+    input |= is_keydown_input(&io->input, SDLK_DOWN) ? NES_INPUT_DOWN : 0;
+    input |= is_keydown_input(&io->input, SDLK_LEFT) ? NES_INPUT_LEFT : 0;
+    input |= is_keydown_input(&io->input, SDLK_RIGHT) ? NES_INPUT_RIGHT : 0;
+    input |= is_keydown_input(&io->input, SDLK_BACKSPACE) ? NES_INPUT_REWIND
+                                                           : 0;
+    input |= is_debug_io(io) ? NES_INPUT_DEBUG : 0;
+    return input;
+}
+
+void *run_emulation(void *data) {
+    emulation_t *emulation = (emulation_t *)data;
+    emulator_t *emu = emulation->emu;
+    pacer_t *pacer = emulation->pacer;
+    while (atomic_load(&emulation->running)) {
+        bool rendered = false;
+        while (atomic_load(&emulation->running) &&
+               is_due_pacer(pacer,
+                            get_time_pacer(),
+                            get_fill_buffer(&emu->apu.buffer))) {
+            unsigned input = atomic_load(&emulation->input);
+
+            // Step back while the rewind key is held, otherwise record history
+            if (input & NES_INPUT_REWIND) {
+                step_back_rewind(emulation->rewind, emu);
+            } else {
+                capture_rewind(emulation->rewind, emu);
+            }
+
+            // Handle controller 1 input
+            joypad_t buttons;
+            buttons.a = input & NES_INPUT_A;
+            buttons.b = input & NES_INPUT_B;
+            buttons.select = input & NES_INPUT_SELECT;
+            buttons.start = input & NES_INPUT_START;
+            buttons.up = input & NES_INPUT_UP;
+            buttons.down = input & NES_INPUT_DOWN;
+            buttons.left = input & NES_INPUT_LEFT;
+            buttons.right = input & NES_INPUT_RIGHT;
+
+            set_joy1_controller(&emu->controller, buttons);
+            if (run_frame_emulator(emu) == EMULATOR_HALT) {
+                atomic_store(&emulation->running, false);
+            }
+            rendered = true;
+        }
+
+        // Frames superseded within a batch are never rendered
+        if (rendered) {
+            unsigned char *pixels = get_back_triple(&emulation->frames);
+            render_io(emulation->io, emu, pixels);
+            if (atomic_load(&emulation->input) & NES_INPUT_DEBUG) {
+                render_debug_io(emulation->io, emu, pixels);
+            }
+            publish_triple(&emulation->frames);
+        }
+
+        // Vsync pacing holds the batch open until its frame was presented
+        if (pacer->batch > 0 && !(pacer->mode == PACER_VSYNC &&
+                                  is_fresh_triple(&emulation->frames))) {
+            present_pacer(pacer);
+        }
+        sleep_pacer(get_wait_pacer(pacer, get_time_pacer()));
+    }
+    return NULL;
+}
+
 int main(int argc, char **argv) {
     // Initialize string buffer for debugging
     char strbuf[1024];
@@ -26,7 +117,7 @@ int main(int argc, char **argv) {
     // Boot up the emulator
     emulator_t emu;
     parse_args(&emu, argc, argv);
-    if (emu.rom.data.buffer == NULL || emu.rom.header.type == NES_INVALID) {
+    if (emu.rom.image == NULL || emu.rom.header.type == NES_INVALID) {
         exit(1);
     }
 
@@ -34,21 +125,71 @@ int main(int argc, char **argv) {
     io_t io;
     create_io(&io, &emu);
 
+    // Load a custom palette
+    const char *palette_file = get_flag_arg(argc, argv, ARG_PALETTE_FILE);
+    if (palette_file) {
+        load_color_table(io.color_table, palette_file);
+    }
+
     // Print ROM information
     read_state_rom(&emu.rom, strbuf, sizeof(strbuf));
     puts(strbuf);
 
-    // Emulate and refresh device IO every frame
-    while (true) {
-        bool emu_state = true;
-        while (emu_state) {
-            unsigned prev_frame = emu.frames;
-            emu_state = update_emulator(&emu);
-            unsigned curr_frame = emu.frames;
+    // Setup rewind history
+    rewind_t rewind;
+    create_rewind(&rewind,
+                  &emu,
+                  NES_REWIND_INTERVAL,
+                  NES_REWIND_LENGTH,
+                  NES_REWIND_BUDGET);
 
-            if (curr_frame > prev_frame) {
-                break;
-            }
+    // Profile guest subroutines
+    callgraph_t callgraph;
+    const char *callgraph_file = get_flag_arg(argc, argv, ARG_CALLGRAPH_FILE);
+    if (callgraph_file) {
+        create_callgraph(&callgraph, emu.cpu.cycles);
+        emu.cpu.callgraph = &callgraph;
+    }
+
+    // Trace the most recent instructions
+    trace_t trace;
+    const char *trace_file = get_flag_arg(argc, argv, ARG_TRACE_FILE);
+    if (trace_file) {
+        create_trace(&trace, NES_TRACE_LENGTH);
+        emu.cpu.trace = &trace;
+    }
+
+    // Schedule frames from the monotonic clock unless asked otherwise
+    pacer_mode_t pacing = PACER_CLOCK;
+    const char *pacing_name = get_flag_arg(argc, argv, ARG_PACING);
+    if (pacing_name && !parse_mode_pacer(pacing_name, &pacing)) {
+        print_usage();
+        exit(1);
+    }
+    pacer_t pacer;
+    create_pacer(&pacer, pacing, get_time_pacer());
+
+    // Emulate on a separate thread so presentation never stalls it
+    emulation_t emulation;
+    emulation.emu = &emu;
+    emulation.io = &io;
+    emulation.rewind = &rewind;
+    emulation.pacer = &pacer;
+    create_triple(&emulation.frames, IO_FRAME_SIZE);
+    atomic_init(&emulation.input, 0);
+    atomic_init(&emulation.running, true);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, run_emulation, &emulation)) {
+        fprintf(stderr, "Error: Unable to start emulation thread\n");
+        exit(1);
+    }
+
+    // Present the latest completed frame every refresh
+    while (atomic_load(&emulation.running)) {
+        // Poll instead of spinning on the same frame if vsync is unavailable
+        if (!acquire_triple(&emulation.frames)) {
+            sleep_pacer(PACER_POLL);
         }
 
         // Handle debug input
@@ -59,27 +200,48 @@ int main(int argc, char **argv) {
             set_debug_io(&io, false);
         }
 
-        // Handle controller 1 input
-        joypad_t buttons;
-        buttons.a = is_keydown_input(&io.input, SDLK_z);
-        buttons.b = is_keydown_input(&io.input, SDLK_x);
-        buttons.select = is_keydown_input(&io.input, SDLK_a);
-        buttons.start = is_keydown_input(&io.input, SDLK_s);
-        buttons.up = is_keydown_input(&io.input, SDLK_UP);
-        buttons.down = is_keydown_input(&io.input, SDLK_DOWN);
-        buttons.left = is_keydown_input(&io.input, SDLK_LEFT);
-        buttons.right = is_keydown_input(&io.input, SDLK_RIGHT);
-
-        set_joy1_controller(&emu.controller, buttons);
-
-        // Refresh IO
-        bool io_state = refresh_io(&io, &emu);
-        if (!emu_state || !io_state) {
-            break;
+        // Refresh IO and hand the input over
+        if (!refresh_io(&io, get_front_triple(&emulation.frames))) {
+            atomic_store(&emulation.running, false);
+        }
+        atomic_store(&emulation.input, read_input_snapshot(&io));
+    }
+    pthread_join(thread, NULL);
+
+    // Count the frames dropped or repeated by the presentation thread as well
+    triple_t *frames = &emulation.frames;
+    pacer.presented = atomic_load(&frames->acquired) +
+                      atomic_load(&frames->duplicated);
+    pacer.dropped += atomic_load(&frames->dropped);
+    pacer.duplicated += atomic_load(&frames->duplicated);
+    print_pacer(&pacer, stdout);
+    destroy_triple(&emulation.frames);
+
+#ifdef NESC_PROFILE
+    print_profile(&emu.cpu_bus.profile, stderr);
+#endif
+
+    // Write the subroutine profile for flamegraph tools
+    if (callgraph_file) {
+        FILE *file = fopen(callgraph_file, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Error: Could not write %s\n", callgraph_file);
+        } else {
+            charge_callgraph(&callgraph, emu.cpu.cycles);
+            write_folded_callgraph(&callgraph, file);
+            fclose(file);
         }
+        destroy_callgraph(&callgraph);
+    }
+
+    // Write the instruction trace for nesc-trace
+    if (trace_file) {
+        save_trace(&trace, trace_file);
+        destroy_trace(&trace);
     }
 
     // Cleanup
+    destroy_rewind(&rewind);
     destroy_io(&io);
     destroy_emulator(&emu);
     return 0;
@@ -2,13 +2,93 @@
 #define NES_H
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "./callgraph.h"
 #include "./emulator.h"
 #include "./io.h"
+#include "./pacer.h"
+#include "./rewind.h"
+#include "./triple.h"
 
-#define ARG_INPUT_FILE "-i"
+#define ARG_INPUT_FILE     "-i"
+#define ARG_PALETTE_FILE   "-p"
+#define ARG_CALLGRAPH_FILE "-g"
+#define ARG_TRACE_FILE     "-t"
+#define ARG_PACING         "-s"
+
+// Rewind history of one snapshot per frame, bounded to 16 MB of deltas
+#define NES_REWIND_INTERVAL 1
+#define NES_REWIND_LENGTH   (60 * 60)
+#define NES_REWIND_BUDGET   (1 << 24)
+
+// Trace the last million instructions, about 24 MB
+#define NES_TRACE_LENGTH (1 << 20)
+
+// Input snapshot bits handed from the presentation thread
+#define NES_INPUT_A      (1 << 0)
+#define NES_INPUT_B      (1 << 1)
+#define NES_INPUT_SELECT (1 << 2)
+#define NES_INPUT_START  (1 << 3)
+#define NES_INPUT_UP     (1 << 4)
+#define NES_INPUT_DOWN   (1 << 5)
+#define NES_INPUT_LEFT   (1 << 6)
+#define NES_INPUT_RIGHT  (1 << 7)
+#define NES_INPUT_REWIND (1 << 8)
+#define NES_INPUT_DEBUG  (1 << 9)
+
+/**
+ * @brief State shared between the emulation and presentation threads.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Emulator, only touched by the emulation thread while it runs.
+     *
+     */
+    emulator_t *emu;
+
+    /**
+     * @brief Device interfaces providing the color table for rendering, the
+     * emulation thread touches nothing else.
+     *
+     */
+    io_t *io;
+
+    /**
+     * @brief Rewind history recorded by the emulation thread.
+     *
+     */
+    rewind_t *rewind;
+
+    /**
+     * @brief Frame scheduler of the emulation thread.
+     *
+     */
+    pacer_t *pacer;
+
+    /**
+     * @brief Rendered frames and their debug planes handed to the
+     * presentation thread.
+     *
+     */
+    triple_t frames;
+
+    /**
+     * @brief Latest input snapshot from the presentation thread.
+     *
+     */
+    atomic_uint input;
+
+    /**
+     * @brief Cleared by either thread to stop both.
+     *
+     */
+    atomic_bool running;
+} emulation_t;
 
 /**
  * @brief Print usage (help) information.
@@ -25,4 +105,31 @@ void print_usage();
  */
 void parse_args(emulator_t *emu, int argc, char **argv);
 
+/**
+ * @brief Get the value following an optional command line flag.
+ *
+ * @param argc
+ * @param argv
+ * @param flag
+ * @return const char* NULL if the flag is not present.
+ */
+const char *get_flag_arg(int argc, char **argv, const char *flag);
+
+/**
+ * @brief Capture the pressed keys as an input snapshot.
+ *
+ * @param io
+ * @return unsigned NES_INPUT_* bits.
+ */
+unsigned read_input_snapshot(io_t *io);
+
+/**
+ * @brief Emulation thread entry, running frames as scheduled by the pacer and
+ * publishing the last of each batch, with its debug views while requested.
+ *
+ * @param data Pointer to the emulation_t.
+ * @return void*
+ */
+void *run_emulation(void *data);
+
 #endif
\ No newline at end of file
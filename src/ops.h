@@ -295,7 +295,7 @@ static const operation_t OP_TABLE[0x100] = {
     {OP_BCC, ADDR_RELATIVE, OPGROUP_NONE},
     {OP_STA, ADDR_INDIRECT_Y, OPGROUP_W},
     {OP_JAM, ADDR_IMPLIED, OPGROUP_NONE},
-    {OP_SHA, ADDR_INDIRECT_Y, OPGROUP_NONE},
+    {OP_SHA, ADDR_INDIRECT_Y, OPGROUP_W},
     {OP_STY, ADDR_ZERO_PAGE_X, OPGROUP_W},
     {OP_STA, ADDR_ZERO_PAGE_X, OPGROUP_W},
     {OP_STX, ADDR_ZERO_PAGE_Y, OPGROUP_W},
@@ -303,11 +303,11 @@ static const operation_t OP_TABLE[0x100] = {
     {OP_TYA, ADDR_IMPLIED, OPGROUP_NONE},
     {OP_STA, ADDR_ABSOLUTE_Y, OPGROUP_W},
     {OP_TXS, ADDR_IMPLIED, OPGROUP_NONE},
-    {OP_TAS, ADDR_ABSOLUTE_Y, OPGROUP_NONE},
-    {OP_SHY, ADDR_ABSOLUTE_X, OPGROUP_NONE},
+    {OP_TAS, ADDR_ABSOLUTE_Y, OPGROUP_W},
+    {OP_SHY, ADDR_ABSOLUTE_X, OPGROUP_W},
     {OP_STA, ADDR_ABSOLUTE_X, OPGROUP_W},
-    {OP_SHX, ADDR_ABSOLUTE_Y, OPGROUP_NONE},
-    {OP_SHA, ADDR_ABSOLUTE_Y, OPGROUP_NONE},
+    {OP_SHX, ADDR_ABSOLUTE_Y, OPGROUP_W},
+    {OP_SHA, ADDR_ABSOLUTE_Y, OPGROUP_W},
     {OP_LDY, ADDR_IMMEDIATE, OPGROUP_R},
     {OP_LDA, ADDR_INDIRECT_X, OPGROUP_R},
     {OP_LDX, ADDR_IMMEDIATE, OPGROUP_R},
@@ -335,7 +335,7 @@ static const operation_t OP_TABLE[0x100] = {
     {OP_CLV, ADDR_IMPLIED, OPGROUP_NONE},
     {OP_LDA, ADDR_ABSOLUTE_Y, OPGROUP_R},
     {OP_TSX, ADDR_IMPLIED, OPGROUP_NONE},
-    {OP_LAS, ADDR_ABSOLUTE_Y, OPGROUP_NONE},
+    {OP_LAS, ADDR_ABSOLUTE_Y, OPGROUP_R},
     {OP_LDY, ADDR_ABSOLUTE_X, OPGROUP_R},
     {OP_LDA, ADDR_ABSOLUTE_X, OPGROUP_R},
     {OP_LDX, ADDR_ABSOLUTE_Y, OPGROUP_R},
@@ -406,6 +406,44 @@ static const operation_t OP_TABLE[0x100] = {
     {OP_ISC, ADDR_ABSOLUTE_X, OPGROUP_RW},
 };
 
+// Expand a macro for each opcode in a row of the opcode matrix
+#define OP_FOREACH_ROW(X, row)                                                 \
+    X(row##0)                                                                  \
+    X(row##1)                                                                  \
+    X(row##2)                                                                  \
+    X(row##3)                                                                  \
+    X(row##4)                                                                  \
+    X(row##5)                                                                  \
+    X(row##6)                                                                  \
+    X(row##7)                                                                  \
+    X(row##8)                                                                  \
+    X(row##9)                                                                  \
+    X(row##A)                                                                  \
+    X(row##B)                                                                  \
+    X(row##C)                                                                  \
+    X(row##D)                                                                  \
+    X(row##E)                                                                  \
+    X(row##F)
+
+// Expand a macro for every opcode in OP_TABLE, in order
+#define OP_FOREACH(X)                                                          \
+    OP_FOREACH_ROW(X, 0x0)                                                     \
+    OP_FOREACH_ROW(X, 0x1)                                                     \
+    OP_FOREACH_ROW(X, 0x2)                                                     \
+    OP_FOREACH_ROW(X, 0x3)                                                     \
+    OP_FOREACH_ROW(X, 0x4)                                                     \
+    OP_FOREACH_ROW(X, 0x5)                                                     \
+    OP_FOREACH_ROW(X, 0x6)                                                     \
+    OP_FOREACH_ROW(X, 0x7)                                                     \
+    OP_FOREACH_ROW(X, 0x8)                                                     \
+    OP_FOREACH_ROW(X, 0x9)                                                     \
+    OP_FOREACH_ROW(X, 0xA)                                                     \
+    OP_FOREACH_ROW(X, 0xB)                                                     \
+    OP_FOREACH_ROW(X, 0xC)                                                     \
+    OP_FOREACH_ROW(X, 0xD)                                                     \
+    OP_FOREACH_ROW(X, 0xE)                                                     \
+    OP_FOREACH_ROW(X, 0xF)
+
 /**
  * @brief Size of an op + operand by address mode.
  *
@@ -428,4 +466,38 @@ static const unsigned char ADDRESS_MODE_SIZES[13] = {
     2, // ADDR_INDIRECT_Y
 };
 
+/**
+ * @brief Mnemonic of each operation, for debugging.
+ *
+ */
+static const char *const MNEMONIC_NAMES[OP_JAM + 1] = {
+    "ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI", "BNE", "BPL", "BRK",
+    "BVC", "BVS", "CLC", "CLD", "CLI", "CLV", "CMP", "CPX", "CPY", "DEC", "DEX",
+    "DEY", "EOR", "INC", "INX", "INY", "JMP", "JSR", "LDA", "LDX", "LDY", "LSR",
+    "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL", "ROR", "RTI", "RTS", "SBC",
+    "SEC", "SED", "SEI", "STA", "STX", "STY", "TAX", "TAY", "TSX", "TXA", "TXS",
+    "TYA", "ALR", "ANC", "ANE", "ARR", "DCP", "ISC", "LAS", "LAX", "LXA", "RLA",
+    "RRA", "SAX", "SBX", "SHA", "SHX", "SHY", "SLO", "SRE", "TAS", "JAM",
+};
+
+/**
+ * @brief Name of each addressing mode, for debugging.
+ *
+ */
+static const char *const ADDRESS_MODE_NAMES[13] = {
+    "implied",
+    "immediate",
+    "accumulator",
+    "relative",
+    "absolute",
+    "absolute,x",
+    "absolute,y",
+    "zero page",
+    "zero page,x",
+    "zero page,y",
+    "indirect",
+    "(indirect,x)",
+    "(indirect),y",
+};
+
 #endif
\ No newline at end of file
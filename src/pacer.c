@@ -0,0 +1,98 @@
+#include "./pacer.h"
+
+double get_time_pacer() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void create_pacer(pacer_t *pacer, pacer_mode_t mode, double now) {
+    pacer->mode = mode;
+    pacer->period = 1.0 / PACER_RATE;
+    pacer->deadline = now;
+    pacer->frames = 0;
+    pacer->batch = 0;
+    pacer->presented = 0;
+    pacer->dropped = 0;
+    pacer->duplicated = 0;
+}
+
+bool parse_mode_pacer(const char *name, pacer_mode_t *mode) {
+    if (strcmp(name, "vsync") == 0) {
+        *mode = PACER_VSYNC;
+    } else if (strcmp(name, "clock") == 0) {
+        *mode = PACER_CLOCK;
+    } else if (strcmp(name, "audio") == 0) {
+        *mode = PACER_AUDIO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool is_due_pacer(pacer_t *pacer, double now, float fill) {
+    bool due = false;
+    if (pacer->batch >= PACER_MAX_FRAMES) {
+        // Restart the schedule after a stall instead of fast-forwarding
+        if (pacer->mode == PACER_CLOCK && now >= pacer->deadline) {
+            pacer->deadline = now + pacer->period;
+        }
+        return false;
+    }
+    switch (pacer->mode) {
+    case PACER_VSYNC:
+        due = pacer->batch == 0;
+        break;
+    case PACER_CLOCK:
+        due = now >= pacer->deadline;
+        if (due) {
+            pacer->deadline += pacer->period;
+        }
+        break;
+    case PACER_AUDIO:
+        due = fill < PACER_AUDIO_FILL;
+        break;
+    }
+    pacer->frames += due;
+    pacer->batch += due;
+    return due;
+}
+
+void present_pacer(pacer_t *pacer) {
+    if (pacer->batch == 0) {
+        pacer->duplicated += pacer->presented > 0;
+    } else {
+        pacer->dropped += pacer->batch - 1;
+    }
+    pacer->batch = 0;
+    pacer->presented++;
+}
+
+double get_wait_pacer(pacer_t *pacer, double now) {
+    switch (pacer->mode) {
+    case PACER_CLOCK:
+        return pacer->deadline > now ? pacer->deadline - now : 0;
+    default:
+        return PACER_POLL;
+    }
+}
+
+void sleep_pacer(double seconds) {
+    if (seconds <= 0) {
+        return;
+    }
+    struct timespec time;
+    time.tv_sec = seconds;
+    time.tv_nsec = (seconds - time.tv_sec) * 1e9;
+    nanosleep(&time, NULL);
+}
+
+void print_pacer(pacer_t *pacer, FILE *file) {
+    fprintf(file,
+            "Frames: %lu emulated, %lu presented, %lu dropped, "
+            "%lu duplicated\n",
+            pacer->frames,
+            pacer->presented,
+            pacer->dropped,
+            pacer->duplicated);
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "./apu.h"
+
+// NTSC frame rate, 29780.5 CPU cycles per frame or about 60.0988 Hz
+#define PACER_RATE (APU_CLOCK_RATE / 29780.5)
+
+// Most frames emulated between presentations before the schedule is reset
+#define PACER_MAX_FRAMES 4
+
+// Audio buffer fill level kept by the audio pacing mode
+#define PACER_AUDIO_FILL 0.5f
+
+// Polling interval of the audio and vsync pacing modes in seconds
+#define PACER_POLL 0.001
+
+/**
+ * @brief Source that decides when the next frame is emulated.
+ *
+ */
+typedef enum {
+    PACER_VSYNC, // One frame per display refresh that presented the last one
+    PACER_CLOCK, // Monotonic clock at the NTSC frame rate
+    PACER_AUDIO, // Audio output buffer draining below its target fill
+} pacer_mode_t;
+
+/**
+ * @brief Frame scheduler decoupling emulation from presentation.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Pacing source.
+     *
+     */
+    pacer_mode_t mode;
+
+    /**
+     * @brief Duration of an emulated frame in seconds.
+     *
+     */
+    double period;
+
+    /**
+     * @brief Time at which the next frame is due.
+     *
+     */
+    double deadline;
+
+    /**
+     * @brief Number of frames emulated.
+     *
+     */
+    unsigned long frames;
+
+    /**
+     * @brief Number of frames emulated since the last presentation.
+     *
+     */
+    unsigned batch;
+
+    /**
+     * @brief Number of display presentations.
+     *
+     */
+    unsigned long presented;
+
+    /**
+     * @brief Number of emulated frames replaced before being presented.
+     *
+     */
+    unsigned long dropped;
+
+    /**
+     * @brief Number of presentations repeating the previous frame.
+     *
+     */
+    unsigned long duplicated;
+} pacer_t;
+
+/**
+ * @brief Get the time of the monotonic clock in seconds.
+ *
+ * @return double
+ */
+double get_time_pacer();
+
+/**
+ * @brief Create the pacer.
+ *
+ * @param pacer
+ * @param mode
+ * @param now Current time in seconds.
+ */
+void create_pacer(pacer_t *pacer, pacer_mode_t mode, double now);
+
+/**
+ * @brief Parse a pacing mode name (vsync, clock or audio).
+ *
+ * @param name
+ * @param mode
+ * @return true
+ * @return false The name is not a pacing mode.
+ */
+bool parse_mode_pacer(const char *name, pacer_mode_t *mode);
+
+/**
+ * @brief Check if another frame should be emulated before the next
+ * presentation, counting it as emulated if so.
+ *
+ * @param pacer
+ * @param now Current time in seconds.
+ * @param fill Fill level of the audio output buffer.
+ * @return true
+ * @return false
+ */
+bool is_due_pacer(pacer_t *pacer, double now, float fill);
+
+/**
+ * @brief Record the presentation of the latest emulated frame.
+ *
+ * @param pacer
+ */
+void present_pacer(pacer_t *pacer);
+
+/**
+ * @brief Get the time to wait before frames may be due again.
+ *
+ * @param pacer
+ * @param now Current time in seconds.
+ * @return double
+ */
+double get_wait_pacer(pacer_t *pacer, double now);
+
+/**
+ * @brief Sleep for a duration in seconds.
+ *
+ * @param seconds
+ */
+void sleep_pacer(double seconds);
+
+/**
+ * @brief Print the frame counters.
+ *
+ * @param pacer
+ * @param file
+ */
+void print_pacer(pacer_t *pacer, FILE *file);
+
+#endif
\ No newline at end of file
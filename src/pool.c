@@ -0,0 +1,105 @@
+#include "./pool.h"
+
+unsigned get_concurrency_pool() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+}
+
+bool pop_pool(pool_deque_t *deque, unsigned *task) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->bottom > deque->top;
+    if (found) {
+        *task = deque->tasks[--deque->bottom];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+bool steal_pool(pool_deque_t *deque, unsigned *task) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->bottom > deque->top;
+    if (found) {
+        *task = deque->tasks[deque->top++];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+void *work_pool(void *arg) {
+    pool_worker_t *worker = arg;
+    pool_t *pool = worker->pool;
+    unsigned task;
+    while (true) {
+        // Drain the own queue first, then steal from the others in turn
+        bool found = pop_pool(&pool->deques[worker->id], &task);
+        for (unsigned i = 1; !found && i < pool->workers; i++) {
+            unsigned victim = (worker->id + i) % pool->workers;
+            found = steal_pool(&pool->deques[victim], &task);
+        }
+
+        // No tasks are added while running, so empty queues mean done
+        if (!found) {
+            return NULL;
+        }
+        pool->task(pool->data, task);
+    }
+}
+
+void run_pool(unsigned count, unsigned workers, pool_task_t task, void *data) {
+    if (workers == 0) {
+        workers = get_concurrency_pool();
+    }
+    if (workers > count) {
+        workers = count ? count : 1;
+    }
+
+    pool_t pool;
+    pool.workers = workers;
+    pool.task = task;
+    pool.data = data;
+    pool.deques = (pool_deque_t *)calloc(workers, sizeof(pool_deque_t));
+    unsigned *tasks = (unsigned *)calloc(count + 1, sizeof(unsigned));
+    pool_worker_t *contexts =
+        (pool_worker_t *)calloc(workers, sizeof(pool_worker_t));
+    pthread_t *threads = (pthread_t *)calloc(workers, sizeof(pthread_t));
+    if (!pool.deques || !tasks || !contexts || !threads) {
+        fprintf(stderr, "Error: Unable to allocate %u workers\n", workers);
+        exit(1);
+    }
+
+    // Shard the tasks into contiguous blocks
+    for (unsigned i = 0; i < count; i++) {
+        tasks[i] = i;
+    }
+    for (unsigned i = 0; i < workers; i++) {
+        pool_deque_t *deque = &pool.deques[i];
+        deque->tasks = tasks;
+        deque->top = (unsigned long)count * i / workers;
+        deque->bottom = (unsigned long)count * (i + 1) / workers;
+        pthread_mutex_init(&deque->lock, NULL);
+    }
+
+    // The calling thread acts as the first worker
+    for (unsigned i = 0; i < workers; i++) {
+        contexts[i].pool = &pool;
+        contexts[i].id = i;
+    }
+    for (unsigned i = 1; i < workers; i++) {
+        if (pthread_create(&threads[i], NULL, work_pool, &contexts[i])) {
+            fprintf(stderr, "Error: Unable to start worker thread %u\n", i);
+            exit(1);
+        }
+    }
+    work_pool(&contexts[0]);
+    for (unsigned i = 1; i < workers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (unsigned i = 0; i < workers; i++) {
+        pthread_mutex_destroy(&pool.deques[i].lock);
+    }
+    free(threads);
+    free(contexts);
+    free(tasks);
+    free(pool.deques);
+}
\ No newline at end of file
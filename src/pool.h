@@ -0,0 +1,118 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief Task executed by the pool for each index.
+ *
+ */
+typedef void (*pool_task_t)(void *data, unsigned index);
+
+/**
+ * @brief Double-ended queue of task indices owned by a worker.
+ *
+ * The owner takes tasks from the bottom while idle workers steal from the
+ * top.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Task indices.
+     *
+     */
+    unsigned *tasks;
+
+    /**
+     * @brief Index of the next task to be stolen.
+     *
+     */
+    unsigned top;
+
+    /**
+     * @brief Index past the next task to be taken by the owner.
+     *
+     */
+    unsigned bottom;
+
+    /**
+     * @brief Guards the ends of the queue.
+     *
+     */
+    pthread_mutex_t lock;
+} pool_deque_t;
+
+/**
+ * @brief Work-stealing thread pool running a fixed set of tasks.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Task queue of each worker.
+     *
+     */
+    pool_deque_t *deques;
+
+    /**
+     * @brief Number of workers.
+     *
+     */
+    unsigned workers;
+
+    /**
+     * @brief Task callback.
+     *
+     */
+    pool_task_t task;
+
+    /**
+     * @brief User data passed to the task callback.
+     *
+     */
+    void *data;
+} pool_t;
+
+/**
+ * @brief Worker thread context.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Pool the worker belongs to.
+     *
+     */
+    pool_t *pool;
+
+    /**
+     * @brief Index of the worker's own task queue.
+     *
+     */
+    unsigned id;
+} pool_worker_t;
+
+/**
+ * @brief Get the number of hardware threads on the host.
+ *
+ * @return unsigned
+ */
+unsigned get_concurrency_pool();
+
+/**
+ * @brief Run tasks 0 to count - 1 across a pool of worker threads,
+ * returning when all of them have completed.
+ *
+ * The tasks are sharded evenly between the workers, and workers that run
+ * out steal from the others.
+ *
+ * @param count Number of tasks
+ * @param workers Number of worker threads, or 0 to match the host
+ * @param task
+ * @param data
+ */
+void run_pool(unsigned count, unsigned workers, pool_task_t task, void *data);
+
+#endif
\ No newline at end of file
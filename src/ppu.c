@@ -1,5 +1,93 @@
 #include "./ppu.h"
 
+#define PPU_EVENT(event) (1u << PPU_EVENT_##event)
+
+// Events in the render and pre-render scanlines, none on dot 0
+#define PPU_RENDER_EVENTS(dot)                                                 \
+    ((dot) == 0                                                                \
+         ? 0                                                                   \
+         : ((((dot) <= 257 || (dot) >= 321)                                    \
+                 ? PPU_TILE_EVENTS(dot)                                        \
+                 : 0) |                                                        \
+            ((((dot) >= 2 && (dot) <= 257) || ((dot) >= 322 && (dot) <= 337)) \
+                 ? PPU_EVENT(SHIFT_REGISTERS)                                  \
+                 : 0) |                                                        \
+            ((((dot) <= 256 || (dot) >= 328) && (dot) % 8 == 0)                \
+                 ? PPU_EVENT(INCREMENT_X)                                      \
+                 : 0) |                                                        \
+            ((dot) == 256 ? PPU_EVENT(INCREMENT_Y) : 0) |                      \
+            ((dot) == 257 ? PPU_EVENT(COPY_X) : 0) |                           \
+            (((dot) >= 257 && (dot) <= 320) ? PPU_EVENT(CLEAR_OAMADDR) : 0) |  \
+            (((dot) <= 64 && (dot) % 2 == 1) ? PPU_EVENT(CLEAR_OAM) : 0) |     \
+            (((dot) >= 65 && (dot) <= 256) ? PPU_EVENT(EVALUATE_SPRITES)       \
+                                           : 0) |                              \
+            (((dot) >= 257 && (dot) <= 320) ? PPU_SPRITE_EVENTS(dot) : 0)))
+
+// Background fetches of a tile
+#define PPU_TILE_EVENTS(dot)                                                   \
+    ((dot) % 8 == 1                                                            \
+         ? ((((dot) >= 9 && (dot) <= 257) || (dot) >= 329)                     \
+                ? PPU_EVENT(RELOAD_SHIFTERS)                                   \
+                : 0)                                                           \
+     : (dot) % 8 == 2 ? PPU_EVENT(FETCH_NAME)                                  \
+     : (dot) % 8 == 4 ? PPU_EVENT(FETCH_ATTRIBUTE)                             \
+     : (dot) % 8 == 6 ? PPU_EVENT(FETCH_PATTERN_LO)                            \
+     : (dot) % 8 == 0 ? PPU_EVENT(FETCH_PATTERN_HI)                            \
+                      : 0)
+
+// Fetches of a sprite
+#define PPU_SPRITE_EVENTS(dot)                                                 \
+    ((dot) % 8 == 4   ? PPU_EVENT(FETCH_ATTRIBUTE_SPRITE)                      \
+     : (dot) % 8 == 6 ? PPU_EVENT(FETCH_PATTERN_SPRITE_LO)                     \
+     : (dot) % 8 == 0 ? PPU_EVENT(FETCH_PATTERN_SPRITE_HI)                     \
+                      : 0)
+
+// Events only in the pre-render scanline
+#define PPU_PRERENDER_EVENTS(dot)                                              \
+    (((dot) == 1 ? PPU_EVENT(CLEAR_FLAGS) : 0) |                               \
+     (((dot) >= 280 && (dot) <= 304) ? PPU_EVENT(COPY_Y) : 0) |                \
+     ((dot) == 338 ? PPU_EVENT(SKIP_CYCLE) : 0))
+
+// Events in the VBlank scanline
+#define PPU_VBLANK_EVENTS(dot) ((dot) == 1 ? PPU_EVENT(SET_VBLANK) : 0)
+
+// Expand a macro for every dot of a scanline
+#define PPU_DOTS_4(X, dot)  X(dot), X((dot) + 1), X((dot) + 2), X((dot) + 3)
+#define PPU_DOTS_16(X, dot)                                                    \
+    PPU_DOTS_4(X, dot), PPU_DOTS_4(X, (dot) + 4), PPU_DOTS_4(X, (dot) + 8),    \
+        PPU_DOTS_4(X, (dot) + 12)
+#define PPU_DOTS_64(X, dot)                                                    \
+    PPU_DOTS_16(X, dot), PPU_DOTS_16(X, (dot) + 16),                           \
+        PPU_DOTS_16(X, (dot) + 32), PPU_DOTS_16(X, (dot) + 48)
+#define PPU_FOREACH_DOT(X)                                                     \
+    PPU_DOTS_64(X, 0), PPU_DOTS_64(X, 64), PPU_DOTS_64(X, 128),                \
+        PPU_DOTS_64(X, 192), PPU_DOTS_64(X, 256), PPU_DOTS_16(X, 320),         \
+        PPU_DOTS_4(X, 336), X(340)
+
+/**
+ * @brief Event schedule of the render scanlines.
+ *
+ */
+static const ppu_events_t PPU_RENDER_SCHEDULE[PPU_LINEDOTS] = {
+    PPU_FOREACH_DOT(PPU_RENDER_EVENTS),
+};
+
+/**
+ * @brief Event schedule of the pre-render scanline.
+ *
+ */
+static const ppu_events_t PPU_PRERENDER_SCHEDULE[PPU_LINEDOTS] = {
+    PPU_FOREACH_DOT(PPU_PRERENDER_EVENTS),
+};
+
+/**
+ * @brief Event schedule of the VBlank scanline.
+ *
+ */
+static const ppu_events_t PPU_VBLANK_SCHEDULE[PPU_LINEDOTS] = {
+    PPU_FOREACH_DOT(PPU_VBLANK_EVENTS),
+};
+
 void create_ppu(ppu_t *ppu, ppu_bus_t *bus, interrupt_t *interrupt) {
     ppu->ctrl = 0;
     ppu->mask = 0;
@@ -15,6 +103,7 @@ void create_ppu(ppu_t *ppu, ppu_bus_t *bus, interrupt_t *interrupt) {
     ppu->dot = ppu->cycles;
 
     ppu->odd_frame = false;
+    ppu->frames = 0;
 
     ppu->bus = bus;
     ppu->interrupt = interrupt;
@@ -25,107 +114,10 @@ void create_ppu(ppu_t *ppu, ppu_bus_t *bus, interrupt_t *interrupt) {
     ppu->sprite_m = 0;
     ppu->sprite_count = 0;
     ppu->sprite_count_latch = 0;
-
-    create_event_tables_ppu(ppu);
 }
 
 void destroy_ppu(ppu_t *ppu) {}
 
-void create_event_tables_ppu(ppu_t *ppu) {
-    unsigned i;
-    for (unsigned dot = 0; dot < PPU_LINEDOTS; dot++) {
-        // Initialize all events to idle
-        for (i = 0; i < PPU_EVENTS_PER_DOT; i++) {
-            ppu->render_events[dot][i] = PPU_EVENT_IDLE;
-            ppu->prerender_events[dot][i] = PPU_EVENT_IDLE;
-            ppu->vblank_events[dot][i] = PPU_EVENT_IDLE;
-        }
-
-        // Skip the first cycle of every scanline
-        if (dot == 0) continue;
-
-        // Prerender scanline events
-        i = 0;
-        if (dot == 1) {
-            ppu->prerender_events[dot][i++] = PPU_EVENT_CLEAR_FLAGS;
-        }
-        if (dot >= 280 && dot <= 304) {
-            ppu->prerender_events[dot][i++] = PPU_EVENT_COPY_Y;
-        }
-        if (dot == 338) {
-            ppu->prerender_events[dot][i++] = PPU_EVENT_SKIP_CYCLE;
-        }
-
-        // VBlank scanline events
-        i = 0;
-        if (dot == 1) {
-            ppu->vblank_events[dot][i++] = PPU_EVENT_SET_VBLANK;
-        }
-
-        // Render scanline events
-        i = 0;
-        if (dot <= 257 || dot >= 321) {
-            switch (dot % 8) {
-            case 1:
-                if ((dot >= 9 && dot <= 257) || dot >= 329) {
-                    ppu->render_events[dot][i++] = PPU_EVENT_RELOAD_SHIFTERS;
-                }
-                break;
-            case 2:
-                ppu->render_events[dot][i++] = PPU_EVENT_FETCH_NAME;
-                break;
-            case 4:
-                ppu->render_events[dot][i++] = PPU_EVENT_FETCH_ATTRIBUTE;
-                break;
-            case 6:
-                ppu->render_events[dot][i++] = PPU_EVENT_FETCH_PATTERN_LO;
-                break;
-            case 0:
-                ppu->render_events[dot][i++] = PPU_EVENT_FETCH_PATTERN_HI;
-                break;
-            }
-        }
-        if ((dot >= 2 && dot <= 257) || (dot >= 322 && dot <= 337)) {
-            ppu->render_events[dot][i++] = PPU_EVENT_SHIFT_REGISTERS;
-        }
-        if ((dot <= 256 || dot >= 328) && dot % 8 == 0) {
-            ppu->render_events[dot][i++] = PPU_EVENT_INCREMENT_X;
-        }
-        if (dot == 256) {
-            ppu->render_events[dot][i++] = PPU_EVENT_INCREMENT_Y;
-        }
-        if (dot == 257) {
-            ppu->render_events[dot][i++] = PPU_EVENT_COPY_X;
-        }
-        if (dot >= 257 && dot <= 320) {
-            ppu->render_events[dot][i++] = PPU_EVENT_CLEAR_OAMADDR;
-        }
-
-        // Sprite events
-        if (dot <= 64 && dot % 2 == 1) {
-            ppu->render_events[dot][i++] = PPU_EVENT_CLEAR_OAM;
-        }
-        if (dot >= 65 && dot <= 256) {
-            ppu->render_events[dot][i++] = PPU_EVENT_EVALUATE_SPRITES;
-        }
-        if (dot >= 257 && dot <= 320) {
-            switch (dot % 8) {
-            case 4:
-                ppu->render_events[dot][i++] = PPU_EVENT_FETCH_ATTRIBUTE_SPRITE;
-                break;
-            case 6:
-                ppu->render_events[dot][i++] =
-                    PPU_EVENT_FETCH_PATTERN_SPRITE_LO;
-                break;
-            case 0:
-                ppu->render_events[dot][i++] =
-                    PPU_EVENT_FETCH_PATTERN_SPRITE_HI;
-                break;
-            }
-        }
-    }
-}
-
 unsigned char read_palette_ppu(ppu_t *ppu, unsigned char palette_index) {
     unsigned char value = ppu->palette[palette_index];
     if (ppu->mask & PPU_MASK_GREYSCALE) {
@@ -460,6 +452,8 @@ void fetch_sprite_attribute_ppu(ppu_t *ppu) {
     unsigned char attr = ppu->secondary_oam[sprite_index * 4 + 2];
     unsigned char x = ppu->secondary_oam[sprite_index * 4 + 3];
     ppu->sprite_latches[sprite_index] = attr;
+    ppu->sprite_index_latches[sprite_index] =
+        ppu->sprite_indices[sprite_index];
     ppu->sprite_counters[sprite_index] = x;
     ppu->sprite_count_latch = ppu->sprite_count;
 }
@@ -526,6 +520,13 @@ void fetch_sprite_pattern_hi_ppu(ppu_t *ppu) {
     ppu->sprite_shift[sprite_index * 2 + 1] = byte;
 }
 
+void write_pixel_ppu(ppu_t *ppu, unsigned dot, unsigned char palette_index) {
+    unsigned char palette_value = read_palette_ppu(ppu, palette_index);
+    unsigned short emphasis = (ppu->mask & PPU_MASK_EMPHASIZE) << 1;
+    unsigned buffer_index = ppu->scanline * PPU_SCREEN_WIDTH + dot;
+    ppu->color_buffer[buffer_index] = (palette_value & 0x3F) | emphasis;
+}
+
 void draw_dot_ppu(ppu_t *ppu) {
     unsigned short x_mask = 0x8000 >> ppu->x;
 
@@ -558,7 +559,7 @@ void draw_dot_ppu(ppu_t *ppu) {
                 ppu->sprite_shift[i * 2] <<= 1;
                 ppu->sprite_shift[i * 2 + 1] <<= 1;
 
-                unsigned char sp_index = ppu->sprite_indices[i];
+                unsigned char sp_index = ppu->sprite_index_latches[i];
                 unsigned char sp_attr = ppu->sprite_latches[i];
 
                 // Get sprite color (and mask if necessary)
@@ -590,22 +591,17 @@ void draw_dot_ppu(ppu_t *ppu) {
         palette_index = (sp_palette << 2) | sp_color;
     }
 
-    // Write to the color buffer
-    unsigned char palette_value = read_palette_ppu(ppu, palette_index);
-    unsigned buffer_index = ppu->scanline * PPU_LINEDOTS + ppu->dot;
-    ppu->color_buffer[buffer_index] =
-        create_color(palette_value,
-                     ppu->mask & PPU_MASK_GREYSCALE,
-                     ppu->mask & PPU_MASK_EMPHASIZE_RED,
-                     ppu->mask & PPU_MASK_EMPHASIZE_GREEN,
-                     ppu->mask & PPU_MASK_EMPHASIZE_BLUE);
+    if (ppu->scanline < PPU_SCREEN_HEIGHT && ppu->dot < PPU_SCREEN_WIDTH) {
+        write_pixel_ppu(ppu, ppu->dot, palette_index);
+    }
 }
 
-void execute_events_ppu(ppu_t *ppu, ppu_event_t *events) {
+void execute_events_ppu(ppu_t *ppu, ppu_events_t events) {
     bool enabled = ppu->mask & (PPU_MASK_SHOW_BG | PPU_MASK_SHOW_SPRITES);
-    unsigned i = 0;
-    while (i < PPU_EVENTS_PER_DOT && events[i] != PPU_EVENT_IDLE) {
-        switch (events[i]) {
+    while (events) {
+        ppu_event_t event = LOWEST_BIT(events);
+        events &= events - 1;
+        switch (event) {
         case PPU_EVENT_SHIFT_REGISTERS:
             if (enabled) {
                 shift_registers_ppu(ppu);
@@ -696,16 +692,14 @@ void execute_events_ppu(ppu_t *ppu, ppu_event_t *events) {
         case PPU_EVENT_SET_VBLANK:
             set_vblank_ppu(ppu);
             break;
-        case PPU_EVENT_IDLE:
-            break;
         }
-        i++;
     }
 }
 
 void advance_frame_ppu(ppu_t *ppu) {
     ppu->scanline = 0;
     ppu->odd_frame = !ppu->odd_frame;
+    ppu->frames++;
 
     // Clear the IO latch every frame (to simulate value decay)
     ppu->io_databus = 0;
@@ -718,15 +712,16 @@ void update_ppu(ppu_t *ppu) {
         advance_frame_ppu(ppu);
         break;
     case PPU_SCANLINE_PRERENDER:
-        execute_events_ppu(ppu, ppu->prerender_events[ppu->dot]);
-        execute_events_ppu(ppu, ppu->render_events[ppu->dot]);
+        execute_events_ppu(ppu,
+                           PPU_PRERENDER_SCHEDULE[ppu->dot] |
+                               PPU_RENDER_SCHEDULE[ppu->dot]);
         break;
     case PPU_SCANLINE_VBLANK:
-        execute_events_ppu(ppu, ppu->vblank_events[ppu->dot]);
+        execute_events_ppu(ppu, PPU_VBLANK_SCHEDULE[ppu->dot]);
         break;
     default:
         if (ppu->scanline < PPU_SCANLINE_IDLE) {
-            execute_events_ppu(ppu, ppu->render_events[ppu->dot]);
+            execute_events_ppu(ppu, PPU_RENDER_SCHEDULE[ppu->dot]);
         }
         break;
     }
@@ -748,4 +743,208 @@ void update_ppu(ppu_t *ppu) {
         ppu->dot = 0;
         ppu->scanline++;
     }
+}
+
+void fetch_tile_ppu(ppu_t *ppu) {
+    fetch_name_ppu(ppu);
+    fetch_attribute_ppu(ppu);
+    fetch_pattern_lo_ppu(ppu);
+    fetch_pattern_hi_ppu(ppu);
+}
+
+void render_background_line_ppu(ppu_t *ppu, unsigned char *line) {
+    unsigned char pixels[PPU_SCREEN_WIDTH + 16];
+
+    // The shifters hold the two tiles prefetched by the previous line, and
+    // their last bit is overwritten by the first tile reloaded on this line
+    decode_planes_tile(ppu->pt_shift[0] >> 8,
+                       ppu->pt_shift[1] >> 8,
+                       ppu->pa_shift[0] >> 8,
+                       ppu->pa_shift[1] >> 8,
+                       pixels);
+    decode_planes_tile(ppu->pt_shift[0],
+                       ppu->pt_shift[1],
+                       ppu->pa_shift[0],
+                       ppu->pa_shift[1],
+                       pixels + 8);
+
+    // Every tile fetched on dots 1-248 is drawn, the last one is only loaded
+    // into the shifters on dot 257
+    unsigned tiles = PPU_SCREEN_WIDTH / 8;
+    for (unsigned tile = 0; tile < tiles; tile++) {
+        fetch_tile_ppu(ppu);
+        increment_x_ppu(ppu);
+        if (tile + 1 < tiles) {
+            decode_row_tile(ppu->pt_latches[0],
+                            ppu->pt_latches[1],
+                            ppu->pa_latch,
+                            pixels + 15 + tile * 8);
+        }
+
+        // Only the second last tile remains in the shifters on dot 256
+        if (tile + 2 == tiles) {
+            reload_shifters_ppu(ppu);
+            for (unsigned i = 0; i < 8; i++) {
+                shift_registers_ppu(ppu);
+            }
+        }
+    }
+    increment_y_ppu(ppu);
+
+    // Dots 0 and 1 both draw the first pixel, as the shifters only start
+    // shifting on dot 2
+    line[0] = pixels[ppu->x];
+    memcpy(line + 1, pixels + ppu->x, PPU_SCREEN_WIDTH - 1);
+
+    // Mask the background
+    unsigned left = (ppu->mask & PPU_MASK_SHOW_BG_LEFT) ? 0 : 8;
+    if (!(ppu->mask & PPU_MASK_SHOW_BG)) {
+        left = PPU_SCREEN_WIDTH;
+    }
+    memset(line, 0, left);
+}
+
+void render_sprites_line_ppu(ppu_t *ppu, unsigned char *line) {
+    if (!(ppu->mask & PPU_MASK_SHOW_SPRITES)) {
+        return;
+    }
+    unsigned char sp_pixels[PPU_SCREEN_WIDTH] = {0};
+    unsigned char sp_priorities[PPU_SCREEN_WIDTH];
+    bool sp_behind_bg[PPU_SCREEN_WIDTH];
+    memset(sp_priorities, 0xFF, PPU_SCREEN_WIDTH);
+
+    // Sprite counters only tick on dots where sprites are drawn, so hiding
+    // the left 8 pixels also delays every sprite by 8 dots
+    unsigned first = (ppu->mask & PPU_MASK_SHOW_SPRITES_LEFT) ? 0 : 8;
+    for (unsigned i = 0; i < ppu->sprite_count_latch; i++) {
+        unsigned char sp_index = ppu->sprite_index_latches[i];
+        unsigned char sp_attr = ppu->sprite_latches[i];
+        unsigned char pt0 = ppu->sprite_shift[i * 2];
+        unsigned char pt1 = ppu->sprite_shift[i * 2 + 1];
+
+        unsigned start = first + ppu->sprite_counters[i];
+        for (unsigned j = 0; j < 8 && start + j < PPU_SCREEN_WIDTH - 1; j++) {
+            unsigned dot = start + j;
+            bool sp_pt0 = (pt0 >> (7 - j)) & 1;
+            bool sp_pt1 = (pt1 >> (7 - j)) & 1;
+            unsigned char sp_color = sp_pt0 | (sp_pt1 << 1);
+            if (!sp_color) {
+                continue;
+            }
+
+            // Detect sprite 0 hit
+            if (sp_index == 0 && line[dot]) {
+                ppu->status |= PPU_STATUS_S0_HIT;
+            }
+
+            // Update palette index depending on pixel priority
+            if (sp_index <= sp_priorities[dot]) {
+                sp_priorities[dot] = sp_index;
+                sp_pixels[dot] = (((sp_attr & 0x3) + 4) << 2) | sp_color;
+                sp_behind_bg[dot] = sp_attr & 0x20;
+            }
+        }
+    }
+
+    // Multiplexer
+    for (unsigned dot = 0; dot < PPU_SCREEN_WIDTH; dot++) {
+        if (!line[dot] || (sp_pixels[dot] && !sp_behind_bg[dot])) {
+            line[dot] = sp_pixels[dot];
+        }
+    }
+}
+
+void render_line_ppu(ppu_t *ppu) {
+    if (ppu->scanline == PPU_SCANLINES) {
+        advance_frame_ppu(ppu);
+    }
+    unsigned char line[PPU_SCREEN_WIDTH] = {0};
+    bool enabled = ppu->mask & (PPU_MASK_SHOW_BG | PPU_MASK_SHOW_SPRITES);
+    if (enabled) {
+        render_background_line_ppu(ppu, line);
+
+        // Evaluate sprites for the next scanline
+        for (ppu->dot = 1; ppu->dot <= 64; ppu->dot += 2) {
+            clear_oam_ppu(ppu);
+        }
+        for (ppu->dot = 65; ppu->dot <= 256; ppu->dot++) {
+            evaluate_sprites_ppu(ppu);
+        }
+
+        // Sprites are drawn from the previous line's fetches before the fetches
+        // for this line overwrite them
+        render_sprites_line_ppu(ppu, line);
+
+        // Dot 257
+        reload_shifters_ppu(ppu);
+        shift_registers_ppu(ppu);
+        copy_x_ppu(ppu);
+        ppu->oamaddr = 0;
+
+        // Dots 258-320
+        for (unsigned sprite = 0; sprite < 8; sprite++) {
+            ppu->dot = 260 + sprite * 8;
+            fetch_sprite_attribute_ppu(ppu);
+            ppu->dot += 2;
+            fetch_sprite_pattern_lo_ppu(ppu);
+            ppu->dot += 2;
+            fetch_sprite_pattern_hi_ppu(ppu);
+        }
+
+        // Dots 321-340 prefetch the first two tiles of the next line
+        for (unsigned tile = 0; tile < 2; tile++) {
+            if (tile > 0) {
+                reload_shifters_ppu(ppu);
+                shift_registers_ppu(ppu);
+            }
+            fetch_tile_ppu(ppu);
+            for (unsigned i = 1; i < 8; i++) {
+                shift_registers_ppu(ppu);
+            }
+            increment_x_ppu(ppu);
+        }
+        reload_shifters_ppu(ppu);
+        shift_registers_ppu(ppu);
+        fetch_name_ppu(ppu);
+        fetch_attribute_ppu(ppu);
+    }
+
+    for (unsigned dot = 0; dot < PPU_SCREEN_WIDTH; dot++) {
+        write_pixel_ppu(ppu, dot, line[dot]);
+    }
+    ppu->cycles += PPU_LINEDOTS;
+    ppu->dot = 0;
+    ppu->scanline++;
+}
+
+void run_ppu(ppu_t *ppu, unsigned long cycles) {
+    while (ppu->cycles < cycles) {
+        // Render whole visible scanlines when no register access can land
+        // inside them
+        bool visible = ppu->scanline < PPU_SCANLINE_IDLE ||
+                       ppu->scanline == PPU_SCANLINES;
+        if (visible && ppu->dot == 0 && cycles - ppu->cycles >= PPU_LINEDOTS) {
+            render_line_ppu(ppu);
+        } else {
+            update_ppu(ppu);
+        }
+    }
+}
+
+unsigned long get_deadline_ppu(ppu_t *ppu) {
+    // Pending suppression and the frame wrap take effect on the next dot
+    if (ppu->suppress_vbl || ppu->suppress_nmi ||
+        ppu->scanline == PPU_SCANLINES) {
+        return ppu->cycles;
+    }
+
+    unsigned long position = ppu->scanline * PPU_LINEDOTS + ppu->dot;
+    unsigned long vblank = PPU_SCANLINE_VBLANK * PPU_LINEDOTS + 1;
+    unsigned long wrap = PPU_SCANLINES * PPU_LINEDOTS;
+    if (position <= vblank) {
+        return ppu->cycles + vblank - position;
+    }
+
+    // The skipped dot on odd frames may bring the wrap one cycle closer
+    return ppu->cycles + wrap - position - 1;
 }
\ No newline at end of file
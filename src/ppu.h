@@ -6,14 +6,16 @@
 #include "./memory.h"
 #include "./ppu_bus.h"
 #include "./rom.h"
+#include "./tile.h"
 #include "./utils.h"
 
 // Rows and columns of the PPU render target
 #define PPU_SCANLINES 262
 #define PPU_LINEDOTS  341
 
-// Maximum number of events per dot
-#define PPU_EVENTS_PER_DOT 15
+// Visible area of the render target
+#define PPU_SCREEN_WIDTH  256
+#define PPU_SCREEN_HEIGHT 240
 
 // PPU scanline segments
 #define PPU_SCANLINE_VISIBLE   0
@@ -39,6 +41,7 @@
 #define PPU_MASK_EMPHASIZE_RED     (1 << 5)
 #define PPU_MASK_EMPHASIZE_GREEN   (1 << 6)
 #define PPU_MASK_EMPHASIZE_BLUE    (1 << 7)
+#define PPU_MASK_EMPHASIZE         0xE0
 
 // PPU status flags
 #define PPU_STATUS_VBLANK     (1 << 7)
@@ -46,32 +49,38 @@
 #define PPU_STATUS_S_OVERFLOW (1 << 5)
 
 /**
- * @brief PPU events that occur per-dot.
+ * @brief PPU events that occur per-dot. Each event is a bit in the per-dot
+ * schedule, and events within a dot execute from the lowest bit upwards.
  *
  */
 typedef enum {
-    PPU_EVENT_IDLE,
+    PPU_EVENT_CLEAR_FLAGS,
+    PPU_EVENT_COPY_Y,
+    PPU_EVENT_SKIP_CYCLE,
+    PPU_EVENT_SET_VBLANK,
+    PPU_EVENT_RELOAD_SHIFTERS,
     PPU_EVENT_FETCH_NAME,
     PPU_EVENT_FETCH_ATTRIBUTE,
     PPU_EVENT_FETCH_PATTERN_LO,
     PPU_EVENT_FETCH_PATTERN_HI,
-    PPU_EVENT_FETCH_ATTRIBUTE_SPRITE,
-    PPU_EVENT_FETCH_PATTERN_SPRITE_LO,
-    PPU_EVENT_FETCH_PATTERN_SPRITE_HI,
     PPU_EVENT_SHIFT_REGISTERS,
-    PPU_EVENT_RELOAD_SHIFTERS,
-    PPU_EVENT_COPY_X,
-    PPU_EVENT_COPY_Y,
     PPU_EVENT_INCREMENT_X,
     PPU_EVENT_INCREMENT_Y,
+    PPU_EVENT_COPY_X,
     PPU_EVENT_CLEAR_OAMADDR,
-    PPU_EVENT_CLEAR_FLAGS,
-    PPU_EVENT_SET_VBLANK,
-    PPU_EVENT_SKIP_CYCLE,
     PPU_EVENT_CLEAR_OAM,
     PPU_EVENT_EVALUATE_SPRITES,
+    PPU_EVENT_FETCH_ATTRIBUTE_SPRITE,
+    PPU_EVENT_FETCH_PATTERN_SPRITE_LO,
+    PPU_EVENT_FETCH_PATTERN_SPRITE_HI,
 } ppu_event_t;
 
+/**
+ * @brief Set of PPU events scheduled on a dot.
+ *
+ */
+typedef unsigned ppu_events_t;
+
 typedef struct {
     /**
      * @brief PPUCTRL register.
@@ -181,6 +190,13 @@ typedef struct {
      */
     unsigned char sprite_indices[8];
 
+    /**
+     * @brief Priority values of the sprites being drawn, latched from
+     * evaluation when the sprites are fetched.
+     *
+     */
+    unsigned char sprite_index_latches[8];
+
     /**
      * @brief Primary object attribute memory.
      *
@@ -278,40 +294,30 @@ typedef struct {
     bool odd_frame;
 
     /**
-     * @brief Output color buffer.
+     * @brief Number of completed frames, advanced on the scanline wrap.
      *
      */
-    color_t color_buffer[PPU_LINEDOTS * PPU_SCANLINES];
+    unsigned long frames;
 
     /**
-     * @brief Pointer to the PPU bus.
+     * @brief Output buffer of color indices for the visible screen. Each
+     * index holds the palette value in its low 6 bits and the emphasis flags
+     * in the high 3 bits, and is converted to RGB only when presented.
      *
      */
-    ppu_bus_t *bus;
+    unsigned short color_buffer[PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT];
 
     /**
-     * @brief Pointer to the interrupt state.
-     *
-     */
-    interrupt_t *interrupt;
-
-    /**
-     * @brief Events in the render and pre-render scanlines.
-     *
-     */
-    ppu_event_t render_events[PPU_LINEDOTS][PPU_EVENTS_PER_DOT];
-
-    /**
-     * @brief Events in the pre-render scanline.
+     * @brief Pointer to the PPU bus.
      *
      */
-    ppu_event_t prerender_events[PPU_LINEDOTS][PPU_EVENTS_PER_DOT];
+    ppu_bus_t *bus;
 
     /**
-     * @brief Events in the VBlank scanline.
+     * @brief Pointer to the interrupt state.
      *
      */
-    ppu_event_t vblank_events[PPU_LINEDOTS][PPU_EVENTS_PER_DOT];
+    interrupt_t *interrupt;
 } ppu_t;
 
 /**
@@ -330,13 +336,6 @@ void create_ppu(ppu_t *ppu, ppu_bus_t *bus, interrupt_t *interrupt);
  */
 void destroy_ppu(ppu_t *ppu);
 
-/**
- * @brief Initialize the per-dot event tables.
- *
- * @param ppu
- */
-void create_event_tables_ppu(ppu_t *ppu);
-
 /**
  * @brief Read from PPUSTATUS.
  *
@@ -441,4 +440,23 @@ bool is_rendering_ppu(ppu_t *ppu);
  */
 void update_ppu(ppu_t *ppu);
 
+/**
+ * @brief Run the PPU until its cycle counter reaches the target.
+ *
+ * @param ppu
+ * @param cycles
+ */
+void run_ppu(ppu_t *ppu, unsigned long cycles);
+
+/**
+ * @brief Get the earliest cycle at which the PPU may change state that is
+ * visible to the CPU without a register access (setting VBlank, raising or
+ * dropping NMI, or wrapping the frame). Running the PPU up to and including
+ * this cycle is required before the CPU can observe it.
+ *
+ * @param ppu
+ * @return unsigned long
+ */
+unsigned long get_deadline_ppu(ppu_t *ppu);
+
 #endif
\ No newline at end of file
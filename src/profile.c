@@ -0,0 +1,134 @@
+#include "./profile.h"
+#include "./cpu_bus.h"
+
+static const char *const PROFILE_REGION_NAMES[PROFILE_REGIONS] = {
+    "RAM",
+    "PPU registers",
+    "APU/IO",
+    "Mapper",
+};
+
+void clear_profile(profile_t *profile) { memset(profile, 0, sizeof(*profile)); }
+
+profile_region_t get_region_profile(address_t address) {
+    if (address < CPU_MAP_PPU_REG) {
+        return PROFILE_REGION_RAM;
+    } else if (address < CPU_MAP_APU_IO) {
+        return PROFILE_REGION_PPU;
+    } else if (address < CPU_MAP_CARTRIDGE) {
+        return PROFILE_REGION_APU_IO;
+    }
+    return PROFILE_REGION_MAPPER;
+}
+
+void record_op_profile(profile_t *profile,
+                       unsigned char opcode,
+                       unsigned long cycles) {
+    address_mode_t mode = OP_TABLE[opcode].address_mode;
+    profile->op_count[opcode]++;
+    profile->op_cycles[opcode] += cycles;
+    profile->mode_count[mode]++;
+    profile->mode_cycles[mode] += cycles;
+}
+
+void merge_profile(profile_t *dst, const profile_t *src) {
+    for (unsigned i = 0; i < 0x100; i++) {
+        dst->op_count[i] += src->op_count[i];
+        dst->op_cycles[i] += src->op_cycles[i];
+    }
+    for (unsigned i = 0; i < PROFILE_ADDRESS_MODES; i++) {
+        dst->mode_count[i] += src->mode_count[i];
+        dst->mode_cycles[i] += src->mode_cycles[i];
+    }
+    for (unsigned i = 0; i < PROFILE_REGIONS; i++) {
+        dst->reads[i] += src->reads[i];
+        dst->writes[i] += src->writes[i];
+    }
+}
+
+void sort_indices_profile(unsigned *indices,
+                          unsigned count,
+                          const unsigned long *keys) {
+    // Insertion sort by descending key, small tables only
+    for (unsigned i = 0; i < count; i++) {
+        indices[i] = i;
+    }
+    for (unsigned i = 1; i < count; i++) {
+        unsigned index = indices[i];
+        unsigned j = i;
+        while (j > 0 && keys[indices[j - 1]] < keys[index]) {
+            indices[j] = indices[j - 1];
+            j--;
+        }
+        indices[j] = index;
+    }
+}
+
+void print_profile(const profile_t *profile, FILE *file) {
+    unsigned long total = 0;
+    for (unsigned i = 0; i < 0x100; i++) {
+        total += profile->op_cycles[i];
+    }
+    double scale = total ? 100.0 / total : 0;
+
+    unsigned indices[0x100];
+    sort_indices_profile(indices, 0x100, profile->op_cycles);
+    fprintf(file,
+            "%-6s %-4s %-13s %14s %14s %7s\n",
+            "opcode",
+            "op",
+            "mode",
+            "count",
+            "cycles",
+            "cycles%");
+    for (unsigned i = 0; i < 0x100 && profile->op_count[indices[i]]; i++) {
+        unsigned opcode = indices[i];
+        operation_t operation = OP_TABLE[opcode];
+        fprintf(file,
+                "$%02X    %-4s %-13s %14lu %14lu %6.2f%%\n",
+                opcode,
+                MNEMONIC_NAMES[operation.mnemonic],
+                ADDRESS_MODE_NAMES[operation.address_mode],
+                profile->op_count[opcode],
+                profile->op_cycles[opcode],
+                profile->op_cycles[opcode] * scale);
+    }
+
+    sort_indices_profile(indices,
+                         PROFILE_ADDRESS_MODES,
+                         profile->mode_cycles);
+    fprintf(file,
+            "\n%-13s %14s %14s %7s\n",
+            "mode",
+            "count",
+            "cycles",
+            "cycles%");
+    for (unsigned i = 0; i < PROFILE_ADDRESS_MODES; i++) {
+        unsigned mode = indices[i];
+        fprintf(file,
+                "%-13s %14lu %14lu %6.2f%%\n",
+                ADDRESS_MODE_NAMES[mode],
+                profile->mode_count[mode],
+                profile->mode_cycles[mode],
+                profile->mode_cycles[mode] * scale);
+    }
+
+    unsigned long accesses[PROFILE_REGIONS];
+    for (unsigned i = 0; i < PROFILE_REGIONS; i++) {
+        accesses[i] = profile->reads[i] + profile->writes[i];
+    }
+    sort_indices_profile(indices, PROFILE_REGIONS, accesses);
+    fprintf(file,
+            "\n%-13s %14s %14s\n",
+            "region",
+            "reads",
+            "writes");
+    for (unsigned i = 0; i < PROFILE_REGIONS; i++) {
+        unsigned region = indices[i];
+        fprintf(file,
+                "%-13s %14lu %14lu\n",
+                PROFILE_REGION_NAMES[region],
+                profile->reads[region],
+                profile->writes[region]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "./ops.h"
+
+#define PROFILE_ADDRESS_MODES 13
+
+/**
+ * @brief CPU bus regions distinguished by the profiler.
+ *
+ */
+typedef enum {
+    PROFILE_REGION_RAM,
+    PROFILE_REGION_PPU,
+    PROFILE_REGION_APU_IO,
+    PROFILE_REGION_MAPPER,
+    PROFILE_REGIONS,
+} profile_region_t;
+
+/**
+ * @brief Execution counters collected when built with NESC_PROFILE.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Executions of each opcode.
+     *
+     */
+    unsigned long op_count[0x100];
+
+    /**
+     * @brief CPU cycles spent in each opcode, including interrupt entry.
+     *
+     */
+    unsigned long op_cycles[0x100];
+
+    /**
+     * @brief Executions of each addressing mode.
+     *
+     */
+    unsigned long mode_count[PROFILE_ADDRESS_MODES];
+
+    /**
+     * @brief CPU cycles spent in each addressing mode.
+     *
+     */
+    unsigned long mode_cycles[PROFILE_ADDRESS_MODES];
+
+    /**
+     * @brief Bus reads of each region.
+     *
+     */
+    unsigned long reads[PROFILE_REGIONS];
+
+    /**
+     * @brief Bus writes to each region.
+     *
+     */
+    unsigned long writes[PROFILE_REGIONS];
+} profile_t;
+
+// Instrumentation hooks, compiled out unless profiling is enabled
+#ifdef NESC_PROFILE
+#define PROFILE_OP(profile, opcode, cycles)                                    \
+    record_op_profile(profile, opcode, cycles)
+#define PROFILE_READ(profile, address)                                         \
+    ((profile)->reads[get_region_profile(address)]++)
+#define PROFILE_WRITE(profile, address)                                        \
+    ((profile)->writes[get_region_profile(address)]++)
+#else
+#define PROFILE_OP(profile, opcode, cycles)
+#define PROFILE_READ(profile, address)
+#define PROFILE_WRITE(profile, address)
+#endif
+
+/**
+ * @brief Reset all counters.
+ *
+ * @param profile
+ */
+void clear_profile(profile_t *profile);
+
+/**
+ * @brief Get the bus region of an address.
+ *
+ * @param address
+ * @return profile_region_t
+ */
+profile_region_t get_region_profile(address_t address);
+
+/**
+ * @brief Count an executed opcode.
+ *
+ * @param profile
+ * @param opcode
+ * @param cycles
+ */
+void record_op_profile(profile_t *profile,
+                       unsigned char opcode,
+                       unsigned long cycles);
+
+/**
+ * @brief Add the counters of one profile to another.
+ *
+ * @param dst
+ * @param src
+ */
+void merge_profile(profile_t *dst, const profile_t *src);
+
+/**
+ * @brief Print the counters as tables sorted by cycles spent.
+ *
+ * @param profile
+ * @param file
+ */
+void print_profile(const profile_t *profile, FILE *file);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "./rewind.h"
+
+void create_rewind(rewind_t *rewind,
+                   emulator_t *emu,
+                   unsigned interval,
+                   unsigned length,
+                   unsigned long budget) {
+    unsigned long size = get_state_size_emulator(emu);
+    rewind->snapshot = allocate_memory(size);
+    rewind->scratch = allocate_memory(size);
+    rewind->delta = allocate_memory(2 * size + 2 * REWIND_RECORD_HEADER);
+    rewind->arena = allocate_memory(budget);
+
+    rewind->entries = (rewind_entry_t *)calloc(length, sizeof(rewind_entry_t));
+    if (rewind->entries == NULL) {
+        fprintf(stderr,
+                "Error: Unable to allocate %u rewind entries\n",
+                length);
+        exit(1);
+    }
+    rewind->capacity = length;
+    rewind->interval = interval;
+    clear_rewind(rewind);
+}
+
+void destroy_rewind(rewind_t *rewind) {
+    free_memory(&rewind->snapshot);
+    free_memory(&rewind->scratch);
+    free_memory(&rewind->delta);
+    free_memory(&rewind->arena);
+    free(rewind->entries);
+}
+
+void clear_rewind(rewind_t *rewind) {
+    rewind->first = 0;
+    rewind->count = 0;
+    rewind->frames = 0;
+    rewind->captured = false;
+}
+
+void write_length_rewind(unsigned char *dst, unsigned length) {
+    dst[0] = length;
+    dst[1] = length >> 8;
+    dst[2] = length >> 16;
+    dst[3] = length >> 24;
+}
+
+unsigned read_length_rewind(const unsigned char *src) {
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((unsigned)src[3] << 24);
+}
+
+unsigned long encode_delta_rewind(const unsigned char *prev,
+                                  const unsigned char *next,
+                                  unsigned long size,
+                                  unsigned char *dst) {
+    unsigned long i = 0;
+    unsigned long length = 0;
+    while (i < size) {
+        // Skip unchanged bytes a word at a time
+        unsigned long start = i;
+        while (i + 8 <= size && !memcmp(prev + i, next + i, 8)) {
+            i += 8;
+        }
+        while (i < size && prev[i] == next[i]) {
+            i++;
+        }
+        unsigned long equal = i - start;
+
+        // Changed bytes run until the next stretch of unchanged bytes that
+        // outweighs a record header
+        start = i;
+        while (i < size) {
+            unsigned long j = i;
+            while (j < size && j - i < REWIND_RECORD_HEADER &&
+                   prev[j] == next[j]) {
+                j++;
+            }
+            if (j - i == REWIND_RECORD_HEADER || j == size) {
+                break;
+            }
+            i = j + 1;
+        }
+
+        write_length_rewind(dst + length, equal);
+        write_length_rewind(dst + length + 4, i - start);
+        length += REWIND_RECORD_HEADER;
+        for (unsigned long j = start; j < i; j++) {
+            dst[length++] = prev[j] ^ next[j];
+        }
+    }
+    return length;
+}
+
+void apply_delta_rewind(unsigned char *state,
+                        const unsigned char *delta,
+                        unsigned long size) {
+    unsigned long i = 0;
+    unsigned long offset = 0;
+    while (offset < size) {
+        i += read_length_rewind(delta + offset);
+        unsigned literals = read_length_rewind(delta + offset + 4);
+        offset += REWIND_RECORD_HEADER;
+        for (unsigned j = 0; j < literals; j++) {
+            state[i++] ^= delta[offset++];
+        }
+    }
+}
+
+unsigned get_newest_rewind(rewind_t *rewind) {
+    return (rewind->first + rewind->count - 1) % rewind->capacity;
+}
+
+void drop_oldest_rewind(rewind_t *rewind) {
+    rewind->first = (rewind->first + 1) % rewind->capacity;
+    rewind->count--;
+}
+
+void push_rewind(rewind_t *rewind, unsigned char *delta, unsigned long size) {
+    if (size > rewind->arena.size) {
+        rewind->count = 0;
+        return;
+    }
+    if (rewind->count == rewind->capacity) {
+        drop_oldest_rewind(rewind);
+    }
+
+    // Allocate after the newest delta, wrapping to the start of the arena
+    unsigned long offset = 0;
+    if (rewind->count) {
+        unsigned newest = get_newest_rewind(rewind);
+        offset = rewind->entries[newest].offset + rewind->entries[newest].size;
+    }
+    unsigned long wrap = offset;
+    bool wrapped = offset + size > rewind->arena.size;
+    if (wrapped) {
+        offset = 0;
+    }
+
+    // Evict the oldest deltas in the way, including any left past the wrap
+    while (rewind->count) {
+        rewind_entry_t oldest = rewind->entries[rewind->first];
+        bool skipped = wrapped && oldest.offset >= wrap;
+        bool overlap = oldest.offset < offset + size &&
+                       offset < oldest.offset + oldest.size;
+        if (!skipped && !overlap) {
+            break;
+        }
+        drop_oldest_rewind(rewind);
+    }
+
+    unsigned index = (rewind->first + rewind->count) % rewind->capacity;
+    rewind->entries[index].offset = offset;
+    rewind->entries[index].size = size;
+    rewind->count++;
+    memcpy(rewind->arena.buffer + offset, delta, size);
+}
+
+void capture_rewind(rewind_t *rewind, emulator_t *emu) {
+    if (rewind->captured && ++rewind->frames < rewind->interval) {
+        return;
+    }
+    rewind->frames = 0;
+    if (!rewind->captured) {
+        save_state_emulator(emu,
+                            rewind->snapshot.buffer,
+                            rewind->snapshot.size);
+        rewind->captured = true;
+        return;
+    }
+
+    // Store the way back to the previous snapshot and keep the new one whole
+    save_state_emulator(emu, rewind->scratch.buffer, rewind->scratch.size);
+    unsigned long size = encode_delta_rewind(rewind->snapshot.buffer,
+                                             rewind->scratch.buffer,
+                                             rewind->snapshot.size,
+                                             rewind->delta.buffer);
+    push_rewind(rewind, rewind->delta.buffer, size);
+
+    memory_t snapshot = rewind->snapshot;
+    rewind->snapshot = rewind->scratch;
+    rewind->scratch = snapshot;
+}
+
+bool step_back_rewind(rewind_t *rewind, emulator_t *emu) {
+    if (rewind->count == 0) {
+        return false;
+    }
+    rewind_entry_t entry = rewind->entries[get_newest_rewind(rewind)];
+    apply_delta_rewind(rewind->snapshot.buffer,
+                       rewind->arena.buffer + entry.offset,
+                       entry.size);
+    rewind->count--;
+    rewind->frames = 0;
+    return load_state_emulator(emu,
+                               rewind->snapshot.buffer,
+                               rewind->snapshot.size);
+}
\ No newline at end of file
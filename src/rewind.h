@@ -0,0 +1,182 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "./emulator.h"
+#include "./memory.h"
+
+// Size of a delta record header (equal run length, literal run length)
+#define REWIND_RECORD_HEADER 8
+
+/**
+ * @brief Location of a delta in the rewind arena.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Offset into the arena.
+     *
+     */
+    unsigned long offset;
+
+    /**
+     * @brief Length in bytes.
+     *
+     */
+    unsigned long size;
+} rewind_entry_t;
+
+/**
+ * @brief Ring of delta-compressed snapshots for stepping the emulator back
+ * in time.
+ *
+ * Only the newest snapshot is kept whole. Each older snapshot is stored as
+ * the run-length encoded XOR against its successor, so the history is
+ * walked backward from the newest snapshot and the oldest deltas can be
+ * dropped freely when the memory budget runs out.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Newest snapshot.
+     *
+     */
+    memory_t snapshot;
+
+    /**
+     * @brief Snapshot being captured.
+     *
+     */
+    memory_t scratch;
+
+    /**
+     * @brief Encoding buffer for the delta being captured.
+     *
+     */
+    memory_t delta;
+
+    /**
+     * @brief Circular arena holding the deltas.
+     *
+     */
+    memory_t arena;
+
+    /**
+     * @brief Ring of delta locations, oldest first.
+     *
+     */
+    rewind_entry_t *entries;
+
+    /**
+     * @brief Capacity of the entries ring.
+     *
+     */
+    unsigned capacity;
+
+    /**
+     * @brief Index of the oldest entry.
+     *
+     */
+    unsigned first;
+
+    /**
+     * @brief Number of deltas stored.
+     *
+     */
+    unsigned count;
+
+    /**
+     * @brief Number of frames between snapshots.
+     *
+     */
+    unsigned interval;
+
+    /**
+     * @brief Frames elapsed since the last snapshot.
+     *
+     */
+    unsigned frames;
+
+    /**
+     * @brief Has the first snapshot been taken?
+     *
+     */
+    bool captured;
+} rewind_t;
+
+/**
+ * @brief Create a rewind buffer.
+ *
+ * @param rewind
+ * @param emu
+ * @param interval Frames between snapshots
+ * @param length Maximum number of snapshots to keep
+ * @param budget Maximum bytes of delta storage
+ */
+void create_rewind(rewind_t *rewind,
+                   emulator_t *emu,
+                   unsigned interval,
+                   unsigned length,
+                   unsigned long budget);
+
+/**
+ * @brief Destroy the rewind buffer.
+ *
+ * @param rewind
+ */
+void destroy_rewind(rewind_t *rewind);
+
+/**
+ * @brief Drop all snapshots.
+ *
+ * @param rewind
+ */
+void clear_rewind(rewind_t *rewind);
+
+/**
+ * @brief Run-length encode the XOR of two equally sized buffers.
+ *
+ * The destination must hold at least 2 * size + 2 * REWIND_RECORD_HEADER
+ * bytes.
+ *
+ * @param prev
+ * @param next
+ * @param size
+ * @param dst
+ * @return unsigned long Size of the encoded delta
+ */
+unsigned long encode_delta_rewind(const unsigned char *prev,
+                                  const unsigned char *next,
+                                  unsigned long size,
+                                  unsigned char *dst);
+
+/**
+ * @brief XOR an encoded delta into a buffer, mapping either of the encoded
+ * buffers to the other.
+ *
+ * @param state
+ * @param delta
+ * @param size Size of the encoded delta
+ */
+void apply_delta_rewind(unsigned char *state,
+                        const unsigned char *delta,
+                        unsigned long size);
+
+/**
+ * @brief Count a frame, taking a snapshot of the emulator every interval.
+ *
+ * @param rewind
+ * @param emu
+ */
+void capture_rewind(rewind_t *rewind, emulator_t *emu);
+
+/**
+ * @brief Restore the emulator to the previous snapshot.
+ *
+ * @param rewind
+ * @param emu
+ * @return true
+ * @return false No older snapshot is available
+ */
+bool step_back_rewind(rewind_t *rewind, emulator_t *emu);
+
+#endif
\ No newline at end of file
@@ -1,63 +1,107 @@
 #include "./rom.h"
 
-void load_rom(rom_t *rom, const char *path) {
-    rom->data.buffer = NULL;
-    rom->data.size = 0;
-
-    // Open file
-    FILE *file = fopen(path, "rb");
-    if (file == NULL) {
+memory_t map_file_rom(const char *path) {
+    memory_t file;
+#ifdef ROM_MMAP
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        fprintf(stderr, "Error: Could not open file \"%s\"\n", path);
+        exit(1);
+    }
+    file.size = info.st_size;
+    file.buffer = NULL;
+    if (file.size) {
+        file.buffer = mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (file.buffer == MAP_FAILED) {
+            fprintf(stderr, "Error: Could not map file \"%s\"\n", path);
+            exit(1);
+        }
+    }
+    close(fd);
+#else
+    FILE *handle = fopen(path, "rb");
+    if (handle == NULL) {
         fprintf(stderr, "Error: Could not open file \"%s\"\n", path);
         exit(1);
     }
+    fseek(handle, 0, SEEK_END);
+    unsigned long size = ftell(handle);
+    fseek(handle, 0, SEEK_SET);
 
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    unsigned long size = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    file = allocate_memory(size);
+    if (fread(file.buffer, 1, file.size, handle) != file.size) {
+        fprintf(stderr, "Error: Could not read file \"%s\"\n", path);
+        exit(1);
+    }
+    fclose(handle);
+#endif
+    return file;
+}
+
+void unmap_file_rom(memory_t *file) {
+#ifdef ROM_MMAP
+    if (file->buffer) {
+        munmap(file->buffer, file->size);
+    }
+    file->buffer = NULL;
+    file->size = 0;
+#else
+    free_memory(file);
+#endif
+}
+
+void load_rom(rom_t *rom, const char *path) {
+    rom->image = NULL;
+    rom->ram.buffer = NULL;
+    rom->ram.size = 0;
 
-    if (size < 16) {
+    memory_t file = map_file_rom(path);
+    if (file.size < ROM_HEADER_SIZE) {
         fprintf(stderr, "Error: ROM is too small\n");
-        fclose(file);
         exit(1);
     }
 
-    // Read the contents of the file
-    memory_t file_buffer = allocate_memory(size);
-    unsigned read = fread(file_buffer.buffer, 1, file_buffer.size, file);
-    if (read != file_buffer.size) {
-        fprintf(stderr, "Error: Could not read file \"%s\"\n", path);
-        fclose(file);
+    // Parse the iNES file
+    rom->header = get_header_rom(file.buffer);
+    unsigned long size = rom->header.trainer_size + rom->header.prg_rom_size +
+                         rom->header.chr_rom_size;
+    if (file.size < ROM_HEADER_SIZE + size) {
+        fprintf(stderr, "Error: ROM is truncated\n");
         exit(1);
     }
 
-    // Parse the iNES file
-    rom->header = get_header_rom(file_buffer.buffer);
-    rom->data =
-        allocate_memory(rom->header.prg_rom_size + rom->header.prg_ram_size +
-                        rom->header.chr_rom_size + rom->header.chr_ram_size +
-                        rom->header.trainer_size);
-
-    // Copy Trainer and ROM data to the buffer
-    unsigned trainer_offset = 0x10;
-    unsigned prg_rom_offset = trainer_offset + rom->header.trainer_size;
-    unsigned chr_rom_offset = prg_rom_offset + rom->header.prg_rom_size;
-    memcpy(get_trainer_rom(rom),
-           file_buffer.buffer + trainer_offset,
-           rom->header.trainer_size);
-    memcpy(get_prg_rom(rom),
-           file_buffer.buffer + prg_rom_offset,
-           rom->header.prg_rom_size);
-    memcpy(get_chr_rom(rom),
-           file_buffer.buffer + chr_rom_offset,
-           rom->header.chr_rom_size);
-
-    // Cleanup and return
-    free_memory(&file_buffer);
-    fclose(file);
+    // Trainer and ROM data are used in place, only cartridge RAM is allocated
+    rom->image = (rom_image_t *)malloc(sizeof(rom_image_t));
+    if (rom->image == NULL) {
+        fprintf(stderr, "Error: Unable to allocate ROM image\n");
+        exit(1);
+    }
+    rom->image->file = file;
+    rom->image->data.buffer = file.buffer + ROM_HEADER_SIZE;
+    rom->image->data.size = size;
+    atomic_init(&rom->image->references, 1);
+    rom->ram =
+        allocate_memory(rom->header.prg_ram_size + rom->header.chr_ram_size);
 }
 
-void unload_rom(rom_t *rom) { free_memory(&rom->data); }
+void copy_rom(rom_t *dst, const rom_t *src) {
+    dst->header = src->header;
+    dst->image = src->image;
+    atomic_fetch_add(&dst->image->references, 1);
+
+    dst->ram = allocate_memory(src->ram.size);
+    memcpy(dst->ram.buffer, src->ram.buffer, src->ram.size);
+}
+
+void unload_rom(rom_t *rom) {
+    free_memory(&rom->ram);
+    if (rom->image && atomic_fetch_sub(&rom->image->references, 1) == 1) {
+        unmap_file_rom(&rom->image->file);
+        free(rom->image);
+    }
+    rom->image = NULL;
+}
 
 rom_header_t get_header_rom(const unsigned char *buffer) {
     rom_header_t header;
@@ -86,6 +130,7 @@ rom_header_t get_header_rom(const unsigned char *buffer) {
     header.prg_rom_size = buffer[4] * (1 << 14);
     header.prg_ram_size = buffer[8] * (1 << 13);
     header.chr_rom_size = buffer[5] * (1 << 13);
+    header.chr_ram_size = 0;
     if (header.prg_ram_size == 0) {
         header.prg_ram_size = 0x2000;
     }
@@ -112,22 +157,24 @@ rom_header_t get_header_rom(const unsigned char *buffer) {
     return header;
 }
 
-unsigned char *get_trainer_rom(rom_t *rom) { return rom->data.buffer; }
+unsigned char *get_trainer_rom(rom_t *rom) { return rom->image->data.buffer; }
 
 unsigned char *get_prg_rom(rom_t *rom) {
     return get_trainer_rom(rom) + rom->header.trainer_size;
 }
 
-unsigned char *get_prg_ram(rom_t *rom) {
+unsigned char *get_prg_ram(rom_t *rom) { return rom->ram.buffer; }
+
+unsigned char *get_chr_rom(rom_t *rom) {
     return get_prg_rom(rom) + rom->header.prg_rom_size;
 }
 
-unsigned char *get_chr_rom(rom_t *rom) {
+unsigned char *get_chr_ram(rom_t *rom) {
     return get_prg_ram(rom) + rom->header.prg_ram_size;
 }
 
-unsigned char *get_chr_ram(rom_t *rom) {
-    return get_chr_rom(rom) + rom->header.chr_rom_size;
+unsigned char *get_chr_memory_rom(rom_t *rom) {
+    return rom->header.chr_rom_size ? get_chr_rom(rom) : get_chr_ram(rom);
 }
 
 void read_state_rom(rom_t *rom, char *buffer, unsigned buffer_size) {
@@ -147,7 +194,7 @@ void read_state_rom(rom_t *rom, char *buffer, unsigned buffer_size) {
              "* Console type: %s\n"
              "* Mapper number: %d\n",
              rom->header.type == NES_1 ? "NES 1" : "NES 2",
-             rom->data.size,
+             rom->image->data.size + rom->ram.size,
              rom->header.trainer_size,
              rom->header.prg_rom_size,
              rom->header.prg_ram_size,
@@ -1,12 +1,25 @@
 #ifndef ROM_H
 #define ROM_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "./memory.h"
 
+// Map ROM files read-only instead of copying them where the host allows
+#if defined(__unix__) || defined(__APPLE__)
+#define ROM_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Size of the iNES header preceding the cartridge data
+#define ROM_HEADER_SIZE 0x10
+
 /**
  * @brief ROM format type.
  *
@@ -109,6 +122,30 @@ typedef struct {
     rom_console_type_t console_type;
 } rom_header_t;
 
+/**
+ * @brief Immutable cartridge image, shared between all copies of a ROM.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Contents of the ROM file, mapped read-only where supported.
+     *
+     */
+    memory_t file;
+
+    /**
+     * @brief Trainer, PRG ROM and CHR ROM, pointing into the file.
+     *
+     */
+    memory_t data;
+
+    /**
+     * @brief Number of ROMs referencing the image.
+     *
+     */
+    atomic_uint references;
+} rom_image_t;
+
 typedef struct {
     /**
      * @brief ROM metadata.
@@ -117,10 +154,16 @@ typedef struct {
     rom_header_t header;
 
     /**
-     * @brief Data buffer.
+     * @brief Shared read-only image.
      *
      */
-    memory_t data;
+    rom_image_t *image;
+
+    /**
+     * @brief Cartridge PRG RAM and CHR RAM owned by this ROM.
+     *
+     */
+    memory_t ram;
 } rom_t;
 
 /**
@@ -132,7 +175,30 @@ typedef struct {
 void load_rom(rom_t *rom, const char *path);
 
 /**
- * @brief Release the ROM.
+ * @brief Map the contents of a file into memory.
+ *
+ * @param path
+ * @return memory_t
+ */
+memory_t map_file_rom(const char *path);
+
+/**
+ * @brief Release a file mapped by map_file_rom().
+ *
+ * @param file
+ */
+void unmap_file_rom(memory_t *file);
+
+/**
+ * @brief Copy a loaded ROM, sharing its image and duplicating its RAM.
+ *
+ * @param dst
+ * @param src
+ */
+void copy_rom(rom_t *dst, const rom_t *src);
+
+/**
+ * @brief Release the ROM, freeing its image along with the last reference.
  *
  * @param rom
  */
@@ -186,6 +252,15 @@ unsigned char *get_chr_rom(rom_t *rom);
  */
 unsigned char *get_chr_ram(rom_t *rom);
 
+/**
+ * @brief Get the pointer to the pattern memory seen by the PPU, which is
+ * CHR RAM for cartridges without CHR ROM.
+ *
+ * @param rom
+ * @return unsigned char*
+ */
+unsigned char *get_chr_memory_rom(rom_t *rom);
+
 /**
  * @brief Read the current state of the cartridge ROM for debugging.
  *
@@ -0,0 +1,59 @@
+#include "./tile.h"
+
+// Spread the bits of a byte into the low bits of 8 bytes, with bit 7 (the
+// leftmost pixel) in the lowest byte
+#define TILE_SPREAD(b)                                                         \
+    ((((b) >> 7) & 1ULL) | (((b) >> 6) & 1ULL) << 8 |                          \
+     (((b) >> 5) & 1ULL) << 16 | (((b) >> 4) & 1ULL) << 24 |                   \
+     (((b) >> 3) & 1ULL) << 32 | (((b) >> 2) & 1ULL) << 40 |                   \
+     (((b) >> 1) & 1ULL) << 48 | ((b) & 1ULL) << 56)
+#define TILE_SPREAD_4(b)                                                       \
+    TILE_SPREAD(b), TILE_SPREAD((b) + 1), TILE_SPREAD((b) + 2),                \
+        TILE_SPREAD((b) + 3)
+#define TILE_SPREAD_16(b)                                                      \
+    TILE_SPREAD_4(b), TILE_SPREAD_4((b) + 4), TILE_SPREAD_4((b) + 8),          \
+        TILE_SPREAD_4((b) + 12)
+#define TILE_SPREAD_64(b)                                                      \
+    TILE_SPREAD_16(b), TILE_SPREAD_16((b) + 16), TILE_SPREAD_16((b) + 32),     \
+        TILE_SPREAD_16((b) + 48)
+
+// Low bit of every byte in a row of 8 pixels
+#define TILE_LOW_BITS 0x0101010101010101ULL
+
+/**
+ * @brief Bit plane expansion table, 8 pixels per entry.
+ *
+ */
+static const unsigned long long TILE_SPREAD_TABLE[256] = {
+    TILE_SPREAD_64(0),
+    TILE_SPREAD_64(64),
+    TILE_SPREAD_64(128),
+    TILE_SPREAD_64(192),
+};
+
+void decode_planes_tile(unsigned char pt0,
+                        unsigned char pt1,
+                        unsigned char pa0,
+                        unsigned char pa1,
+                        unsigned char *pixels) {
+    unsigned long long color =
+        TILE_SPREAD_TABLE[pt0] | TILE_SPREAD_TABLE[pt1] << 1;
+    unsigned long long palette =
+        TILE_SPREAD_TABLE[pa0] << 2 | TILE_SPREAD_TABLE[pa1] << 3;
+
+    // Drop the palette of transparent pixels
+    unsigned long long opaque = (color | color >> 1) & TILE_LOW_BITS;
+    unsigned long long row = color | (palette & (opaque * 0x0C));
+    for (unsigned i = 0; i < 8; i++) {
+        pixels[i] = row >> (i * 8);
+    }
+}
+
+void decode_row_tile(unsigned char lo,
+                     unsigned char hi,
+                     unsigned char attribute,
+                     unsigned char *pixels) {
+    unsigned char pa0 = (attribute & 1) * 0xFF;
+    unsigned char pa1 = ((attribute >> 1) & 1) * 0xFF;
+    decode_planes_tile(lo, hi, pa0, pa1, pixels);
+}
\ No newline at end of file
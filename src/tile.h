@@ -0,0 +1,38 @@
+#ifndef TILE_H
+#define TILE_H
+
+/**
+ * @brief Decode 8 pixels from the four bit planes of the background
+ * shifters: pattern low, pattern high, attribute low and attribute high.
+ * Bit 7 of each plane is the leftmost pixel.
+ *
+ * Each pixel is written as a palette index, (palette << 2) | color, where
+ * transparent pixels (color 0) are always 0.
+ *
+ * @param pt0
+ * @param pt1
+ * @param pa0
+ * @param pa1
+ * @param pixels
+ */
+void decode_planes_tile(unsigned char pt0,
+                        unsigned char pt1,
+                        unsigned char pa0,
+                        unsigned char pa1,
+                        unsigned char *pixels);
+
+/**
+ * @brief Decode a row of a 2bpp tile into 8 palette indices, leftmost pixel
+ * first.
+ *
+ * @param lo Low pattern table byte.
+ * @param hi High pattern table byte.
+ * @param attribute 2-bit palette attribute.
+ * @param pixels
+ */
+void decode_row_tile(unsigned char lo,
+                     unsigned char hi,
+                     unsigned char attribute,
+                     unsigned char *pixels);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "./trace.h"
+
+void create_trace(trace_t *trace, unsigned long capacity) {
+    unsigned long size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    trace->entries = (trace_entry_t *)malloc(size * sizeof(trace_entry_t));
+    if (trace->entries == NULL) {
+        fprintf(stderr, "Error: Unable to allocate %lu trace entries\n", size);
+        exit(1);
+    }
+    trace->mask = size - 1;
+    trace->count = 0;
+}
+
+void destroy_trace(trace_t *trace) { free(trace->entries); }
+
+void clear_trace(trace_t *trace) { trace->count = 0; }
+
+unsigned long get_length_trace(trace_t *trace) {
+    return trace->count > trace->mask ? trace->mask + 1 : trace->count;
+}
+
+trace_entry_t *get_entry_trace(trace_t *trace, unsigned long index) {
+    unsigned long first = trace->count - get_length_trace(trace);
+    return &trace->entries[(first + index) & trace->mask];
+}
+
+void format_entry_trace(const trace_entry_t *entry,
+                        char *buffer,
+                        unsigned buffer_size) {
+    // Only the operand bytes of the instruction are shown
+    char bytes[16];
+    operation_t operation = OP_TABLE[entry->opcode];
+    switch (ADDRESS_MODE_SIZES[operation.address_mode]) {
+    case 1:
+        snprintf(bytes, sizeof(bytes), "%02X", entry->opcode);
+        break;
+    case 2:
+        snprintf(bytes,
+                 sizeof(bytes),
+                 "%02X %02X",
+                 entry->opcode,
+                 entry->operands[0]);
+        break;
+    default:
+        snprintf(bytes,
+                 sizeof(bytes),
+                 "%02X %02X %02X",
+                 entry->opcode,
+                 entry->operands[0],
+                 entry->operands[1]);
+        break;
+    }
+    snprintf(buffer,
+             buffer_size,
+             "%04X  %-8s  A:%02X X:%02X Y:%02X P:%02X SP:%02X "
+             "PPU:%3d,%3d CYC:%lu",
+             entry->pc,
+             bytes,
+             entry->a,
+             entry->x,
+             entry->y,
+             entry->p,
+             entry->s,
+             entry->scanline,
+             entry->dot,
+             entry->cycles);
+}
+
+bool save_trace(trace_t *trace, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Could not write %s\n", path);
+        return false;
+    }
+
+    trace_header_t header = {{'N', 'E', 'S', 'T'}, TRACE_VERSION, 0};
+    header.count = get_length_trace(trace);
+    fwrite(&header, sizeof(header), 1, file);
+
+    // The ring wraps at most once, so the entries are written in two runs
+    unsigned long first = (trace->count - header.count) & trace->mask;
+    unsigned long tail = trace->mask + 1 - first;
+    if (tail > header.count) {
+        tail = header.count;
+    }
+    fwrite(trace->entries + first, sizeof(trace_entry_t), tail, file);
+    fwrite(trace->entries, sizeof(trace_entry_t), header.count - tail, file);
+    fclose(file);
+    return true;
+}
+
+bool load_trace(trace_t *trace, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Could not open %s\n", path);
+        return false;
+    }
+
+    trace_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, "NEST", 4) != 0 ||
+        header.version != TRACE_VERSION) {
+        fprintf(stderr, "Error: %s is not a trace file\n", path);
+        fclose(file);
+        return false;
+    }
+
+    // The entry count must match the rest of the file before allocating
+    long start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    unsigned long size = ftell(file) - start;
+    fseek(file, start, SEEK_SET);
+    if (header.count > size / sizeof(trace_entry_t)) {
+        fprintf(stderr, "Error: %s is truncated\n", path);
+        fclose(file);
+        return false;
+    }
+
+    create_trace(trace, header.count);
+    trace->count = fread(trace->entries,
+                         sizeof(trace_entry_t),
+                         header.count,
+                         file);
+    fclose(file);
+    if (trace->count != header.count) {
+        fprintf(stderr, "Error: Could not read %s\n", path);
+        destroy_trace(trace);
+        return false;
+    }
+    return true;
+}
+
+void print_trace(trace_t *trace, FILE *file) {
+    char buffer[128];
+    unsigned long length = get_length_trace(trace);
+    for (unsigned long i = 0; i < length; i++) {
+        format_entry_trace(get_entry_trace(trace, i), buffer, sizeof(buffer));
+        fprintf(file, "%s\n", buffer);
+    }
+}
\ No newline at end of file
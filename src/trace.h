@@ -0,0 +1,172 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "./memory.h"
+#include "./ops.h"
+
+// Trace file format version
+#define TRACE_VERSION 1
+
+/**
+ * @brief CPU state before an instruction is executed.
+ *
+ */
+typedef struct {
+    /**
+     * @brief CPU cycle count.
+     *
+     */
+    unsigned long cycles;
+
+    /**
+     * @brief Program counter.
+     *
+     */
+    address_t pc;
+
+    /**
+     * @brief PPU scanline and dot.
+     *
+     */
+    short scanline, dot;
+
+    /**
+     * @brief Opcode and the two bytes following it.
+     *
+     */
+    unsigned char opcode, operands[2];
+
+    /**
+     * @brief Registers and status flags.
+     *
+     */
+    unsigned char a, x, y, p, s;
+} trace_entry_t;
+
+/**
+ * @brief Header of a trace file, followed by its entries oldest first.
+ *
+ */
+typedef struct {
+    char magic[4];
+    unsigned version;
+    unsigned long count;
+} trace_header_t;
+
+/**
+ * @brief Fixed-size ring of the most recently executed instructions.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Ring buffer of entries.
+     *
+     */
+    trace_entry_t *entries;
+
+    /**
+     * @brief Capacity minus one, the capacity is a power of two.
+     *
+     */
+    unsigned long mask;
+
+    /**
+     * @brief Number of entries recorded since the trace was cleared.
+     *
+     */
+    unsigned long count;
+} trace_t;
+
+/**
+ * @brief Create the trace ring.
+ *
+ * @param trace
+ * @param capacity Number of entries, rounded up to a power of two.
+ */
+void create_trace(trace_t *trace, unsigned long capacity);
+
+/**
+ * @brief Destroy the trace ring.
+ *
+ * @param trace
+ */
+void destroy_trace(trace_t *trace);
+
+/**
+ * @brief Drop all recorded entries.
+ *
+ * @param trace
+ */
+void clear_trace(trace_t *trace);
+
+/**
+ * @brief Get the next entry to be filled, overwriting the oldest once the
+ * ring is full.
+ *
+ * @param trace
+ * @return trace_entry_t*
+ */
+static inline trace_entry_t *push_trace(trace_t *trace) {
+    return &trace->entries[trace->count++ & trace->mask];
+}
+
+/**
+ * @brief Get the number of entries held by the ring.
+ *
+ * @param trace
+ * @return unsigned long
+ */
+unsigned long get_length_trace(trace_t *trace);
+
+/**
+ * @brief Get a held entry, 0 being the oldest.
+ *
+ * @param trace
+ * @param index
+ * @return trace_entry_t*
+ */
+trace_entry_t *get_entry_trace(trace_t *trace, unsigned long index);
+
+/**
+ * @brief Render an entry as a nestest.log line.
+ *
+ * @param entry
+ * @param buffer
+ * @param buffer_size
+ */
+void format_entry_trace(const trace_entry_t *entry,
+                        char *buffer,
+                        unsigned buffer_size);
+
+/**
+ * @brief Write the held entries to a binary trace file.
+ *
+ * @param trace
+ * @param path
+ * @return true
+ * @return false
+ */
+bool save_trace(trace_t *trace, const char *path);
+
+/**
+ * @brief Load a binary trace file, replacing the trace ring.
+ *
+ * @param trace
+ * @param path
+ * @return true
+ * @return false The file is invalid and nothing was allocated.
+ */
+bool load_trace(trace_t *trace, const char *path);
+
+/**
+ * @brief Write the held entries as nestest.log text, oldest first.
+ *
+ * @param trace
+ * @param file
+ */
+void print_trace(trace_t *trace, FILE *file);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "./triple.h"
+
+void create_triple(triple_t *triple, unsigned long size) {
+    for (unsigned i = 0; i < 3; i++) {
+        triple->buffers[i] = allocate_memory(size);
+    }
+    triple->back = 0;
+    triple->front = 1;
+    atomic_init(&triple->middle, 2);
+    atomic_init(&triple->published, 0);
+    atomic_init(&triple->dropped, 0);
+    atomic_init(&triple->acquired, 0);
+    atomic_init(&triple->duplicated, 0);
+}
+
+void destroy_triple(triple_t *triple) {
+    for (unsigned i = 0; i < 3; i++) {
+        free_memory(&triple->buffers[i]);
+    }
+}
+
+unsigned char *get_back_triple(triple_t *triple) {
+    return triple->buffers[triple->back].buffer;
+}
+
+unsigned char *get_front_triple(triple_t *triple) {
+    return triple->buffers[triple->front].buffer;
+}
+
+void publish_triple(triple_t *triple) {
+    // Release the frame contents along with the index, acquiring the buffer
+    // the consumer last released in exchange
+    unsigned middle = atomic_exchange_explicit(&triple->middle,
+                                               triple->back | TRIPLE_FRESH,
+                                               memory_order_acq_rel);
+    triple->back = middle & ~TRIPLE_FRESH;
+    atomic_fetch_add_explicit(&triple->published, 1, memory_order_relaxed);
+    if (middle & TRIPLE_FRESH) {
+        atomic_fetch_add_explicit(&triple->dropped, 1, memory_order_relaxed);
+    }
+}
+
+bool acquire_triple(triple_t *triple) {
+    // Only the consumer clears the flag, so it cannot be lost in between
+    if (!is_fresh_triple(triple)) {
+        if (atomic_load_explicit(&triple->acquired, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&triple->duplicated,
+                                      1,
+                                      memory_order_relaxed);
+        }
+        return false;
+    }
+    unsigned middle = atomic_exchange_explicit(&triple->middle,
+                                               triple->front,
+                                               memory_order_acq_rel);
+    triple->front = middle & ~TRIPLE_FRESH;
+    atomic_fetch_add_explicit(&triple->acquired, 1, memory_order_relaxed);
+    return true;
+}
+
+bool is_fresh_triple(triple_t *triple) {
+    return atomic_load_explicit(&triple->middle, memory_order_relaxed) &
+           TRIPLE_FRESH;
+}
\ No newline at end of file
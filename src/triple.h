@@ -0,0 +1,130 @@
+#ifndef TRIPLE_H
+#define TRIPLE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "./memory.h"
+
+// Flag on the shared index marking a published buffer not yet acquired
+#define TRIPLE_FRESH 4
+
+/**
+ * @brief Triple buffer handing complete frames from a producer thread to a
+ * consumer thread without locks.
+ *
+ * The producer fills the back buffer and the consumer reads the front buffer,
+ * each exclusively. Publishing and acquiring atomically swap one of them with
+ * the shared middle buffer, so neither side ever waits and the consumer
+ * always sees the latest complete frame.
+ *
+ */
+typedef struct {
+    /**
+     * @brief Frame storage.
+     *
+     */
+    memory_t buffers[3];
+
+    /**
+     * @brief Index of the buffer owned by the producer.
+     *
+     */
+    unsigned back;
+
+    /**
+     * @brief Index of the buffer owned by the consumer.
+     *
+     */
+    unsigned front;
+
+    /**
+     * @brief Index of the shared buffer and the fresh flag.
+     *
+     */
+    atomic_uint middle;
+
+    /**
+     * @brief Number of frames published by the producer.
+     *
+     */
+    atomic_ulong published;
+
+    /**
+     * @brief Number of published frames replaced before being acquired.
+     *
+     */
+    atomic_ulong dropped;
+
+    /**
+     * @brief Number of acquires that found a new frame.
+     *
+     */
+    atomic_ulong acquired;
+
+    /**
+     * @brief Number of acquires that kept the previous frame.
+     *
+     */
+    atomic_ulong duplicated;
+} triple_t;
+
+/**
+ * @brief Create the triple buffer with zeroed buffers.
+ *
+ * @param triple
+ * @param size Size of each buffer in bytes.
+ */
+void create_triple(triple_t *triple, unsigned long size);
+
+/**
+ * @brief Destroy the triple buffer.
+ *
+ * @param triple
+ */
+void destroy_triple(triple_t *triple);
+
+/**
+ * @brief Get the buffer being filled by the producer.
+ *
+ * @param triple
+ * @return unsigned char*
+ */
+unsigned char *get_back_triple(triple_t *triple);
+
+/**
+ * @brief Get the buffer being read by the consumer.
+ *
+ * @param triple
+ * @return unsigned char*
+ */
+unsigned char *get_front_triple(triple_t *triple);
+
+/**
+ * @brief Publish the back buffer as the latest frame. Only called from the
+ * producer thread.
+ *
+ * @param triple
+ */
+void publish_triple(triple_t *triple);
+
+/**
+ * @brief Take the latest published frame as the front buffer. Only called
+ * from the consumer thread.
+ *
+ * @param triple
+ * @return true
+ * @return false No frame was published since the last acquire.
+ */
+bool acquire_triple(triple_t *triple);
+
+/**
+ * @brief Check if a published frame is waiting to be acquired.
+ *
+ * @param triple
+ * @return true
+ * @return false
+ */
+bool is_fresh_triple(triple_t *triple);
+
+#endif
\ No newline at end of file
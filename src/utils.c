@@ -5,4 +5,22 @@ unsigned char reverse_bits(unsigned char bits) {
     bits = (bits & 0xCC) >> 2 | (bits & 0x33) << 2;
     bits = (bits & 0xAA) >> 1 | (bits & 0x55) << 1;
     return bits;
+}
+
+unsigned lowest_bit(unsigned bits) {
+    unsigned index = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+}
+
+unsigned long long
+hash_bytes(unsigned long long hash, const void *bytes, unsigned long size) {
+    const unsigned char *data = bytes;
+    for (unsigned long i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
 }
\ No newline at end of file
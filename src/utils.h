@@ -9,4 +9,33 @@
  */
 unsigned char reverse_bits(unsigned char bits);
 
+/**
+ * @brief Get the index of the lowest set bit of a non-zero integer.
+ *
+ * @param bits
+ * @return unsigned
+ */
+unsigned lowest_bit(unsigned bits);
+
+// FNV-1a offset basis, the initial value of hash_bytes()
+#define HASH_SEED 0xcbf29ce484222325ULL
+
+/**
+ * @brief Update a 64-bit FNV-1a hash with a block of bytes.
+ *
+ * @param hash
+ * @param bytes
+ * @param size
+ * @return unsigned long long
+ */
+unsigned long long
+hash_bytes(unsigned long long hash, const void *bytes, unsigned long size);
+
+// Use the compiler's bit scan builtin where available
+#if defined(__GNUC__) || defined(__clang__)
+#define LOWEST_BIT(bits) ((unsigned)__builtin_ctz(bits))
+#else
+#define LOWEST_BIT(bits) lowest_bit(bits)
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include <stdio.h>
+
+#include "./ctest.h"
+
+#include "../../src/apu.h"
+#include "../../src/cpu_bus.h"
+#include "../../src/emulator.h"
+
+int tests_run = 0;
+
+char message[1024] = {0};
+
+static unsigned read_output(apu_t *apu, float *samples, unsigned count) {
+    unsigned size = read_buffer(&apu->buffer,
+                                (unsigned char *)samples,
+                                count * sizeof(float));
+    return size / sizeof(float);
+}
+
+static void play_a440(apu_t *apu) {
+    // Period 253 plays A440 on pulse 1 at constant volume with 50% duty
+    write_register_apu(apu, APU_REG_STATUS, APU_STATUS_PULSE1);
+    write_register_apu(apu, APU_REG_FRAME_COUNTER, APU_FRAME_IRQ_INHIBIT);
+    write_register_apu(apu, APU_REG_PULSE1_0, 0xbf);
+    write_register_apu(apu, APU_REG_PULSE1_2, 253);
+    write_register_apu(apu, APU_REG_PULSE1_3, 0x08);
+}
+
+static char *test_blip_step() {
+    blip_t blip;
+    create_blip(&blip, APU_CLOCK_RATE, APU_SAMPLE_RATE, 0x200);
+    add_delta_blip(&blip, 100, 1.0f);
+    end_frame_blip(&blip, 4096);
+
+    // Band-limited step settles on the new level after the kernel
+    float samples[0x200];
+    unsigned count = read_samples_blip(&blip, samples, 0x200);
+    mu_assert("Blip sample count", count >= 100);
+    mu_assert("Blip before step", fabsf(samples[0]) < 1e-3f);
+    for (unsigned i = 40; i < count; i++) {
+        snprintf(message, sizeof(message), "Blip after step (%u)", i);
+        mu_assert(message, fabsf(samples[i] - 1.0f) < 1e-2f);
+    }
+    destroy_blip(&blip);
+    return 0;
+}
+
+static char *test_sample_rate() {
+    apu_t apu;
+    interrupt_t interrupt;
+    reset_interrupt(&interrupt);
+    create_apu(&apu, NULL, &interrupt);
+
+    // One NTSC frame of APU cycles yields roughly 734 samples, less the tail
+    // still waiting for the next flush
+    float samples[0x400];
+    unsigned total = 0;
+    for (unsigned frame = 0; frame < 60; frame++) {
+        for (unsigned i = 0; i < 29780 / 2; i++) {
+            update_apu(&apu);
+        }
+        total += read_output(&apu, samples, 0x400);
+    }
+    snprintf(message, sizeof(message), "Samples per frame (%u)", total / 60);
+    mu_assert(message, total / 60 >= 731 && total / 60 <= 734);
+    destroy_apu(&apu);
+    return 0;
+}
+
+static char *test_rate_control() {
+    apu_t apu;
+    interrupt_t interrupt;
+    reset_interrupt(&interrupt);
+    create_apu(&apu, NULL, &interrupt);
+    set_rate_apu(&apu, 48000, true);
+
+    // Draining every frame keeps the buffer empty, so the rate is raised
+    float samples[0x400];
+    unsigned total = 0;
+    for (unsigned frame = 0; frame < 60; frame++) {
+        for (unsigned i = 0; i < APU_FLUSH_CYCLES / 2; i++) {
+            update_apu(&apu);
+        }
+        total += read_output(&apu, samples, 0x400);
+    }
+    snprintf(message, sizeof(message), "Raised rate (%u)", total / 60);
+    mu_assert(message, total / 60 >= 801 && total / 60 <= 803);
+
+    // Filling the buffer lowers the rate below nominal
+    double nominal = 48000.0 / APU_CLOCK_RATE * (1ull << BLIP_FRACTION_BITS);
+    while (get_fill_buffer(&apu.buffer) < 1) {
+        update_apu(&apu);
+    }
+    for (unsigned i = 0; i < APU_FLUSH_CYCLES / 2; i++) {
+        update_apu(&apu);
+    }
+    mu_assert("Lowered rate",
+              apu.blip.factor < nominal * (1 - APU_RATE_CONTROL * 0.9));
+    mu_assert("Overrun counted", get_overruns_buffer(&apu.buffer) > 0);
+    destroy_apu(&apu);
+
+    // A 192 kHz flush outgrows the default capacity, so the buffer grows to
+    // fit the raised rate rather than dropping deltas past its end
+    create_apu(&apu, NULL, &interrupt);
+    set_rate_apu(&apu, 192000, false);
+    mu_assert("192 kHz capacity",
+              apu.blip.size > 192000 * (1 + APU_RATE_CONTROL) *
+                                  APU_FLUSH_CYCLES / APU_CLOCK_RATE);
+    play_a440(&apu);
+    float wide[0x1000];
+    unsigned crossings = 0;
+    float previous = 0;
+    total = 0;
+    for (unsigned frame = 0; frame < 60; frame++) {
+        for (unsigned i = 0; i < APU_FLUSH_CYCLES / 2; i++) {
+            update_apu(&apu);
+        }
+        unsigned count = read_output(&apu, wide, 0x1000);
+        for (unsigned j = 0; j < count; j++) {
+            crossings += previous < 0 && wide[j] >= 0;
+            previous = wide[j];
+        }
+        total += count;
+    }
+    snprintf(message, sizeof(message), "192 kHz rate (%u)", total / 60);
+    mu_assert(message, total / 60 >= 3192 && total / 60 <= 3195);
+    snprintf(message, sizeof(message), "192 kHz frequency (%u)", crossings);
+    mu_assert(message, crossings >= 435 && crossings <= 445);
+    destroy_apu(&apu);
+
+    // The output buffer grows as well, so rate control holds it near half
+    // full against a device consuming 192 kHz in real time
+    create_apu(&apu, NULL, &interrupt);
+    set_rate_apu(&apu, 192000, true);
+    while (get_fill_buffer(&apu.buffer) < 0.5f) {
+        update_apu(&apu);
+    }
+    double owed = 0;
+    for (unsigned frame = 0; frame < 600; frame++) {
+        for (unsigned i = 0; i < APU_FLUSH_CYCLES / 2; i++) {
+            update_apu(&apu);
+        }
+        owed += 192000.0 * APU_FLUSH_CYCLES / APU_CLOCK_RATE;
+        unsigned count = owed;
+        owed -= count;
+        read_output(&apu, wide, count);
+    }
+    float fill = get_fill_buffer(&apu.buffer);
+    snprintf(message, sizeof(message), "192 kHz fill (%.2f)", fill);
+    mu_assert(message, fill > 0.3f && fill < 0.7f);
+    mu_assert("192 kHz overruns", get_overruns_buffer(&apu.buffer) == 0);
+    mu_assert("192 kHz underruns", get_underruns_buffer(&apu.buffer) == 0);
+    destroy_apu(&apu);
+    return 0;
+}
+
+static char *test_pulse_frequency() {
+    apu_t apu;
+    interrupt_t interrupt;
+    reset_interrupt(&interrupt);
+    create_apu(&apu, NULL, &interrupt);
+
+    play_a440(&apu);
+
+    // Count rising zero crossings over one second of output
+    float samples[0x400];
+    unsigned crossings = 0;
+    unsigned total = 0;
+    float previous = 0;
+    for (unsigned long i = 0; i < APU_CLOCK_RATE / 2; i++) {
+        update_apu(&apu);
+        if (i % 0x400 == 0) {
+            unsigned count = read_output(&apu, samples, 0x400);
+            for (unsigned j = 0; j < count; j++) {
+                crossings += previous < 0 && samples[j] >= 0;
+                previous = samples[j];
+            }
+            total += count;
+        }
+    }
+    snprintf(message, sizeof(message), "Pulse frequency (%u)", crossings);
+    mu_assert(message, crossings >= 435 && crossings <= 445);
+    mu_assert("Pulse sample count", total >= 44000 && total <= 44200);
+    destroy_apu(&apu);
+    return 0;
+}
+
+static char *test_status() {
+    apu_t apu;
+    interrupt_t interrupt;
+    reset_interrupt(&interrupt);
+    create_apu(&apu, NULL, &interrupt);
+
+    // Length counters only load while their channel is enabled
+    write_register_apu(&apu, APU_REG_NOISE_3, 0x08);
+    mu_assert("Disabled length", read_status_apu(&apu) == 0);
+    write_register_apu(&apu,
+                       APU_REG_STATUS,
+                       APU_STATUS_PULSE2 | APU_STATUS_NOISE);
+    write_register_apu(&apu, APU_REG_PULSE2_3, 0x08);
+    write_register_apu(&apu, APU_REG_NOISE_3, 0x18);
+    mu_assert("Enabled length",
+              read_status_apu(&apu) == (APU_STATUS_PULSE2 | APU_STATUS_NOISE));
+    write_register_apu(&apu, APU_REG_STATUS, APU_STATUS_NOISE);
+    mu_assert("Cleared length", read_status_apu(&apu) == APU_STATUS_NOISE);
+
+    // Halt flag is clear, so two half frames count the noise length down to zero
+    for (unsigned i = 0; i < 2 * APU_FRAME_STEP_4; i++) {
+        update_apu(&apu);
+    }
+    mu_assert("Frame IRQ", get_irq_interrupt(&interrupt));
+    mu_assert("Expired length",
+              read_status_apu(&apu) == APU_STATUS_FRAME_IRQ);
+    mu_assert("Frame IRQ acknowledge", !get_irq_interrupt(&interrupt));
+    mu_assert("Frame IRQ cleared", read_status_apu(&apu) == 0);
+
+    // Inhibit flag blocks the frame IRQ
+    write_register_apu(&apu, APU_REG_FRAME_COUNTER, APU_FRAME_IRQ_INHIBIT);
+    for (unsigned i = 0; i < 2 * APU_FRAME_STEP_4; i++) {
+        update_apu(&apu);
+    }
+    mu_assert("Frame IRQ inhibit", !get_irq_interrupt(&interrupt));
+    destroy_apu(&apu);
+    return 0;
+}
+
+static char *test_bus_registers() {
+    emulator_t emu;
+    create_emulator(&emu, "../roms/nestest/nestest.nes");
+
+    // Register writes through the CPU bus land in the APU
+    write_cpu_bus(&emu.cpu_bus, APU_REG_NOISE_2, 0x81);
+    mu_assert("Noise mode", emu.apu.noise.mode);
+    mu_assert("Noise period", emu.apu.noise.period == 4);
+
+    destroy_emulator(&emu);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_blip_step);
+    mu_run_test(test_sample_rate);
+    mu_run_test(test_rate_control);
+    mu_run_test(test_pulse_frequency);
+    mu_run_test(test_status);
+    mu_run_test(test_bus_registers);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
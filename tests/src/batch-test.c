@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./ctest.h"
+
+#include "../../src/batch.h"
+
+int tests_run = 0;
+
+static const char *MANIFEST = "batch-test.txt";
+static const char *MOVIE = "batch-test.movie";
+static const char *OUTPUT = "batch-test.hashes";
+
+static void write_manifest() {
+    // Pressing start on every other frame
+    FILE *file = fopen(MOVIE, "wb");
+    for (unsigned i = 0; i < 20; i++) {
+        fputc((i & 1) << 3, file);
+    }
+    fclose(file);
+
+    file = fopen(MANIFEST, "w");
+    fprintf(file, "# rom movie frames output\n");
+    for (unsigned i = 0; i < 6; i++) {
+        fprintf(file, "../roms/sprite_hit_tests/01.basics.nes - 20 -\n");
+    }
+    fprintf(file, "\n");
+    fprintf(file, "../roms/nestest/nestest.nes %s 20 %s\n", MOVIE, OUTPUT);
+    fprintf(file, "../roms/nestest/nestest.nes - 20 -\n");
+    fclose(file);
+}
+
+static void remove_manifest() {
+    remove(MANIFEST);
+    remove(MOVIE);
+    remove(OUTPUT);
+}
+
+static char *test_manifest() {
+    write_manifest();
+
+    batch_t batch;
+    load_manifest_batch(&batch, MANIFEST);
+    mu_assert("Job count", batch.count == 8);
+    mu_assert("Shared ROMs", batch.rom_count == 2);
+    mu_assert("Shared ROM", batch.jobs[0].rom == batch.jobs[5].rom);
+    mu_assert("Movie", batch.jobs[6].movie.size == 20);
+    mu_assert("No movie", is_free_memory(&batch.jobs[7].movie));
+    mu_assert("Output", strcmp(batch.jobs[6].output_path, OUTPUT) == 0);
+    mu_assert("No output", batch.jobs[7].output_path[0] == 0);
+
+    destroy_batch(&batch);
+    remove_manifest();
+    return 0;
+}
+
+static char *test_run() {
+    write_manifest();
+
+    batch_t batch;
+    load_manifest_batch(&batch, MANIFEST);
+    run_batch(&batch, 3);
+
+    // Identical jobs agree regardless of the worker that ran them
+    for (unsigned i = 0; i < 6; i++) {
+        batch_job_t *job = &batch.jobs[i];
+        mu_assert("Frames run", job->frames_run == 20);
+        mu_assert("Status", job->status == EMULATOR_FRAME);
+        mu_assert("RAM hash", job->ram_hash == batch.jobs[0].ram_hash);
+        mu_assert("Frame hash", job->frame_hash == batch.jobs[0].frame_hash);
+    }
+
+    // A single-threaded rerun matches
+    batch_job_t job = batch.jobs[6];
+    run_job_batch(&job);
+    mu_assert("Rerun RAM hash", job.ram_hash == batch.jobs[6].ram_hash);
+    mu_assert("Rerun frame hash", job.frame_hash == batch.jobs[6].frame_hash);
+
+    // Every frame is hashed, ending with the last one
+    FILE *file = fopen(OUTPUT, "r");
+    unsigned long long hash = 0;
+    unsigned lines = 0;
+    while (fscanf(file, "%llx", &hash) == 1) {
+        lines++;
+    }
+    fclose(file);
+    mu_assert("Frame hash lines", lines == 20);
+    mu_assert("Last frame hash", hash == job.frame_hash);
+
+    destroy_batch(&batch);
+    remove_manifest();
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_manifest);
+    mu_run_test(test_run);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+
+    // Failed assertions return before their test cleans up
+    remove_manifest();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -111,11 +113,87 @@ static char *test_clear() {
     return 0;
 }
 
+static char *test_counters() {
+    buffer_t buffer;
+    create_buffer(&buffer, 4);
+    unsigned char x[6] = {1, 2, 3, 4, 5, 6};
+
+    mu_assert("Buffer capacity", get_capacity_buffer(&buffer) == 4);
+    mu_assert("Buffer fill", get_fill_buffer(&buffer) == 0.0f);
+
+    write_buffer(&buffer, x, 3);
+    mu_assert("Buffer fill", get_fill_buffer(&buffer) == 0.75f);
+    mu_assert("Buffer overruns", get_overruns_buffer(&buffer) == 0);
+    write_buffer(&buffer, x, 3);
+    mu_assert("Buffer overruns", get_overruns_buffer(&buffer) == 1);
+
+    read_buffer(&buffer, x, 4);
+    mu_assert("Buffer underruns", get_underruns_buffer(&buffer) == 0);
+    read_buffer(&buffer, x, 1);
+    mu_assert("Buffer underruns", get_underruns_buffer(&buffer) == 1);
+    mu_assert("Buffer fill", get_fill_buffer(&buffer) == 0.0f);
+
+    destroy_buffer(&buffer);
+    return 0;
+}
+
+static void *produce_buffer(void *data) {
+    buffer_t *buffer = (buffer_t *)data;
+    unsigned char value = 0;
+    unsigned long written = 0;
+    while (written < 100000) {
+        // Write odd-sized batches so copies straddle the wrap-around
+        unsigned char batch[7];
+        for (unsigned i = 0; i < sizeof(batch); i++) {
+            batch[i] = value + i;
+        }
+        unsigned length = write_buffer(buffer, batch, sizeof(batch));
+
+        // Yield when stalled so a single core still makes progress
+        if (length < sizeof(batch)) {
+            sched_yield();
+        }
+        value += length;
+        written += length;
+    }
+    return NULL;
+}
+
+static char *test_concurrent() {
+    buffer_t buffer;
+    create_buffer(&buffer, 64);
+    pthread_t producer;
+    pthread_create(&producer, NULL, produce_buffer, &buffer);
+
+    // Consumer must observe the exact sequence written by the producer
+    unsigned char expected = 0;
+    unsigned long read = 0;
+    bool ordered = true;
+    while (read < 100000) {
+        unsigned char batch[5];
+        unsigned length = read_buffer(&buffer, batch, sizeof(batch));
+        if (length < sizeof(batch)) {
+            sched_yield();
+        }
+        for (unsigned i = 0; i < length; i++) {
+            ordered &= batch[i] == expected++;
+        }
+        read += length;
+    }
+    pthread_join(producer, NULL);
+
+    mu_assert("Concurrent order", ordered);
+    destroy_buffer(&buffer);
+    return 0;
+}
+
 static char *all_tests() {
     mu_run_test(test_write);
     mu_run_test(test_read);
     mu_run_test(test_overlapping_rw);
     mu_run_test(test_clear);
+    mu_run_test(test_counters);
+    mu_run_test(test_concurrent);
     return 0;
 }
 
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./ctest.h"
+
+#include "../../src/emulator.h"
+
+int tests_run = 0;
+
+static const char *TEST_ROM = "../roms/sprite_hit_tests/01.basics.nes";
+
+static char *test_call_stack() {
+    callgraph_t graph;
+    create_callgraph(&graph, 0);
+
+    // reset -> $8000 -> $9000, then back to reset
+    enter_callgraph(&graph, 0x8000, 0, 0xfb, 10);
+    enter_callgraph(&graph, 0x9000, 0, 0xf9, 15);
+    leave_callgraph(&graph, 0xfb, 25);
+    leave_callgraph(&graph, 0xfd, 30);
+    mu_assert("Depth", graph.depth == 1);
+
+    // Second call of $8000 reuses its node
+    enter_callgraph(&graph, 0x8000, 0, 0xfb, 40);
+    mu_assert("Shared node", graph.node_count == 3);
+
+    // NMI handler leaves by discarding the frames below it
+    enter_callgraph(&graph, 0xc000, CPU_VEC_NMI, 0xf8, 42);
+    enter_callgraph(&graph, 0x9000, 0, 0xf6, 50);
+    leave_callgraph(&graph, 0xfb, 60);
+    mu_assert("Unwound", graph.depth == 2);
+    leave_callgraph(&graph, 0xfd, 61);
+    charge_callgraph(&graph, 70);
+
+    char output[0x400] = {0};
+    FILE *file = tmpfile();
+    write_folded_callgraph(&graph, file);
+    rewind(file);
+    fread(output, 1, sizeof(output) - 1, file);
+    fclose(file);
+    mu_assert("Root", strstr(output, "reset 29\n"));
+    mu_assert("Subroutine", strstr(output, "reset;$8000 13\n"));
+    mu_assert("Nested", strstr(output, "reset;$8000;$9000 10\n"));
+    mu_assert("NMI", strstr(output, "reset;$8000;nmi:$C000 8\n"));
+    mu_assert("NMI callee",
+              strstr(output, "reset;$8000;nmi:$C000;$9000 10\n"));
+
+    destroy_callgraph(&graph);
+    return 0;
+}
+
+static char *test_attribution() {
+    emulator_t emu;
+    create_emulator(&emu, TEST_ROM);
+    callgraph_t graph;
+    create_callgraph(&graph, emu.cpu.cycles);
+    emu.cpu.callgraph = &graph;
+
+    unsigned long cycles = emu.cpu.cycles;
+    for (unsigned i = 0; i < 60; i++) {
+        run_frame_emulator(&emu);
+    }
+    charge_callgraph(&graph, emu.cpu.cycles);
+
+    // Every cycle is charged to exactly one node
+    unsigned long total = 0;
+    for (unsigned i = 0; i < graph.node_count; i++) {
+        total += graph.nodes[i].cycles;
+    }
+    mu_assert("Subroutines seen", graph.node_count > 1);
+    mu_assert("Total cycles", total == emu.cpu.cycles - cycles);
+
+    destroy_callgraph(&graph);
+    destroy_emulator(&emu);
+    return 0;
+}
+
+static char *test_load_state() {
+    emulator_t emu;
+    create_emulator(&emu, TEST_ROM);
+    callgraph_t graph;
+    create_callgraph(&graph, emu.cpu.cycles);
+    emu.cpu.callgraph = &graph;
+
+    unsigned long start = emu.cpu.cycles;
+    unsigned long size = get_state_size_emulator(&emu);
+    unsigned char *state = (unsigned char *)malloc(size);
+    for (unsigned i = 0; i < 10; i++) {
+        run_frame_emulator(&emu);
+    }
+    save_state_emulator(&emu, state, size);
+    unsigned long saved = emu.cpu.cycles;
+    for (unsigned i = 0; i < 30; i++) {
+        run_frame_emulator(&emu);
+    }
+    unsigned long rolled_back = emu.cpu.cycles - saved;
+    charge_callgraph(&graph, emu.cpu.cycles);
+
+    // Rolled back cycles stay charged, but are not subtracted again
+    mu_assert("Load state", load_state_emulator(&emu, state, size));
+    mu_assert("Resync cycles", graph.cycles == saved);
+    for (unsigned i = 1; i < graph.depth; i++) {
+        mu_assert("Resync stack", graph.stack[i].s >= emu.cpu.s);
+    }
+    for (unsigned i = 0; i < 30; i++) {
+        run_frame_emulator(&emu);
+    }
+    charge_callgraph(&graph, emu.cpu.cycles);
+
+    unsigned long total = 0;
+    for (unsigned i = 0; i < graph.node_count; i++) {
+        mu_assert("Node cycles", graph.nodes[i].cycles <= emu.cpu.cycles);
+        total += graph.nodes[i].cycles;
+    }
+    mu_assert("Total cycles", total == emu.cpu.cycles - start + rolled_back);
+
+    free(state);
+    destroy_callgraph(&graph);
+    destroy_emulator(&emu);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_call_stack);
+    mu_run_test(test_attribution);
+    mu_run_test(test_load_state);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./ctest.h"
+
+#include "../../src/color.h"
+
+int tests_run = 0;
+
+static bool equal_color(color_t a, color_t b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static char *test_default_table() {
+    color_t table[COLOR_TABLE_SIZE];
+    create_color_table(table);
+    for (unsigned i = 0; i < 64; i++) {
+        mu_assert("Palette color", equal_color(table[i], COLOR_PALETTE[i]));
+    }
+
+    // Red emphasis boosts red and dims green and blue
+    color_t base = COLOR_PALETTE[0x21];
+    color_t red = table[0x21 | 0x40];
+    mu_assert("Red emphasis", red.r == min(base.r * 3 / 2, 0xff));
+    mu_assert("Red emphasis", red.g == base.g / 2);
+    mu_assert("Red emphasis", red.b == base.b / 2);
+    return 0;
+}
+
+static char *test_load_table() {
+    const char *path = "color-test.pal";
+    unsigned char rgb[COLOR_INDICES * 3];
+    for (unsigned i = 0; i < sizeof(rgb); i++) {
+        rgb[i] = i * 7;
+    }
+
+    // 64-entry palette with approximated emphasis
+    FILE *file = fopen(path, "wb");
+    fwrite(rgb, 1, 64 * 3, file);
+    fclose(file);
+
+    color_t table[COLOR_TABLE_SIZE];
+    load_color_table(table, path);
+    for (unsigned i = 0; i < 64; i++) {
+        color_t color = {rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]};
+        mu_assert("64-entry color", equal_color(table[i], color));
+    }
+    mu_assert("64-entry emphasis",
+              table[0x80 | 5].g == min(rgb[16] * 3 / 2, 0xff));
+
+    // 512-entry palette with explicit emphasis
+    file = fopen(path, "wb");
+    fwrite(rgb, 1, sizeof(rgb), file);
+    fclose(file);
+
+    load_color_table(table, path);
+    for (unsigned i = 0; i < COLOR_INDICES; i++) {
+        color_t color = {rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]};
+        mu_assert("512-entry color", equal_color(table[i], color));
+    }
+    remove(path);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_default_table);
+    mu_run_test(test_load_table);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
@@ -65,12 +65,32 @@ static char *test_stack() {
     return 0;
 }
 
+static char *test_open_bus() {
+    emulator_t emu;
+    create_emulator(&emu, "../roms/nestest/nestest.nes");
+
+    // Internal RAM is mirrored through $1FFF
+    write_cpu_bus(&emu.cpu_bus, 0x0801, 0x5A);
+    mu_assert("RAM mirror", read_cpu_bus(&emu.cpu_bus, 0x1801) == 0x5A);
+    mu_assert("RAM storage", emu.cpu_bus.memory[0x0001] == 0x5A);
+
+    // Unmapped I/O reads return the last value on the data bus
+    read_cpu_bus(&emu.cpu_bus, 0x0001);
+    mu_assert("Open bus", read_cpu_bus(&emu.cpu_bus, 0x4000) == 0x5A);
+    write_cpu_bus(&emu.cpu_bus, 0x4018, 0x3C);
+    mu_assert("Open bus write", read_cpu_bus(&emu.cpu_bus, 0x4018) == 0x3C);
+
+    destroy_emulator(&emu);
+    return 0;
+}
+
 static char *all_tests() {
     mu_run_test(test_mirror_ram);
     mu_run_test(test_mirror_ppu);
     mu_run_test(test_mirror_apu);
     mu_run_test(test_mapper0);
     mu_run_test(test_stack);
+    mu_run_test(test_open_bus);
     return 0;
 }
 
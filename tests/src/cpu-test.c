@@ -22,23 +22,32 @@ static char *test_nestest() {
     }
     fseek(file, 0, SEEK_SET);
 
-    // Compare each line with runtime CPU state
+    // Trace the whole run
+    trace_t trace;
+    create_trace(&trace, lines);
+    emu.cpu.trace = &trace;
+    bool running = true;
+    for (unsigned long i = 0; running && i < lines; i++) {
+        running = update_emulator(&emu);
+    }
+    mu_assert("NESTEST trace is incomplete",
+              get_length_trace(&trace) == lines);
+
+    // Compare each line with the decoded CPU state
     char src[256];
     char dst[256];
-    bool running = true;
-    unsigned line_num = 1;
-    while (running && lines) {
+    for (unsigned long i = 0; i < lines; i++) {
         fgets(src, sizeof(src), file);
         src[strlen(src) - 2] = 0;
-        read_state_cpu(&emu.cpu, dst, sizeof(dst));
-        printf("L%d %s %lu\n", line_num, src, strlen(src));
-        printf("L%d %s %lu\n\n", line_num, dst, strlen(dst));
+        format_entry_trace(get_entry_trace(&trace, i), dst, sizeof(dst));
+        if (strcmp(src, dst) != 0) {
+            printf("L%lu %s\n", i + 1, src);
+            printf("L%lu %s\n\n", i + 1, dst);
+        }
         mu_assert("NESTEST CPU state does not match nestest.log",
                   strcmp(src, dst) == 0);
-        running = update_emulator(&emu);
-        lines--;
-        line_num++;
     }
+    destroy_trace(&trace);
 
     // Read the final test result in 0x2
     mu_assert("NESTEST result is not succesful",
@@ -49,6 +58,46 @@ static char *test_nestest() {
     return 0;
 }
 
+static char *test_trace_ring() {
+    const char *path = "cpu-test.trace";
+    trace_t trace;
+    create_trace(&trace, 3);
+    mu_assert("Trace capacity", trace.mask == 3);
+
+    // Only the newest entries are kept once the ring wraps
+    for (unsigned i = 0; i < 10; i++) {
+        push_trace(&trace)->pc = i;
+    }
+    mu_assert("Trace length", get_length_trace(&trace) == 4);
+    mu_assert("Trace oldest", get_entry_trace(&trace, 0)->pc == 6);
+    mu_assert("Trace newest", get_entry_trace(&trace, 3)->pc == 9);
+
+    // Saved files hold the entries oldest first
+    trace_t loaded;
+    mu_assert("Trace save", save_trace(&trace, path));
+    mu_assert("Trace load", load_trace(&loaded, path));
+    mu_assert("Loaded length", get_length_trace(&loaded) == 4);
+    for (unsigned i = 0; i < 4; i++) {
+        mu_assert("Loaded entry", get_entry_trace(&loaded, i)->pc == 6 + i);
+    }
+
+    // Counts beyond the file contents are rejected before allocating
+    trace_header_t header;
+    FILE *file = fopen(path, "r+b");
+    fread(&header, sizeof(header), 1, file);
+    header.count = ~0ul;
+    rewind(file);
+    fwrite(&header, sizeof(header), 1, file);
+    fclose(file);
+    trace_t corrupt;
+    mu_assert("Trace corrupt", !load_trace(&corrupt, path));
+    remove(path);
+
+    destroy_trace(&loaded);
+    destroy_trace(&trace);
+    return 0;
+}
+
 static char *test_blargg_instr_test_v5() {
     const char *test_roms[20] = {
         "../roms/instr_test_v5/01-basics.nes",
@@ -70,8 +119,6 @@ static char *test_blargg_instr_test_v5() {
         "../roms/instr_misc/01-abs_x_wrap.nes",
         "../roms/instr_misc/02-branch_wrap.nes",
         "../roms/instr_misc/03-dummy_reads.nes",
-
-        // TODO: Run this as soon as APU is setup
         "../roms/instr_misc/04-dummy_reads_apu.nes",
     };
 
@@ -82,7 +129,7 @@ static char *test_blargg_instr_test_v5() {
     unsigned char status = 0;
     char result[64] = {0};
 
-    for (unsigned i = 0; i < 19; i++) {
+    for (unsigned i = 0; i < 20; i++) {
         emulator_t emu;
         create_emulator(&emu, test_roms[i]);
 
@@ -128,6 +175,7 @@ static char *test_blargg_instr_test_v5() {
 
 static char *all_tests() {
     mu_run_test(test_nestest);
+    mu_run_test(test_trace_ring);
     mu_run_test(test_blargg_instr_test_v5);
     return 0;
 }
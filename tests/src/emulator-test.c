@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./ctest.h"
+
+#include "../../src/emulator.h"
+
+int tests_run = 0;
+
+static const char *TEST_ROM = "../roms/sprite_hit_tests/01.basics.nes";
+
+static char *test_save_load_state() {
+    emulator_t emu;
+    create_emulator(&emu, TEST_ROM);
+    for (unsigned i = 0; i < 20; i++) {
+        run_frame_emulator(&emu);
+    }
+    run_cycles_emulator(&emu, 1234);
+
+    unsigned long size = get_state_size_emulator(&emu);
+    unsigned char *state = malloc(size);
+    mu_assert("Save state", save_state_emulator(&emu, state, size) == size);
+    mu_assert("Save state capacity",
+              save_state_emulator(&emu, state, size - 1) == 0);
+
+    // Run ahead and record the result
+    static unsigned short frame[PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT];
+    for (unsigned i = 0; i < 10; i++) {
+        run_frame_emulator(&emu);
+    }
+    unsigned long cycles = emu.cpu.cycles;
+    unsigned char ram[CPU_MAP_MIRROR_0];
+    memcpy(ram, emu.cpu_bus.memory, sizeof(ram));
+    memcpy(frame, emu.ppu.color_buffer, sizeof(frame));
+
+    // Replaying from the restored state reaches the same point
+    mu_assert("Load state", load_state_emulator(&emu, state, size));
+    for (unsigned i = 0; i < 10; i++) {
+        run_frame_emulator(&emu);
+    }
+    mu_assert("Restored cycles", emu.cpu.cycles == cycles);
+    mu_assert("Restored RAM", !memcmp(ram, emu.cpu_bus.memory, sizeof(ram)));
+    mu_assert("Restored frame",
+              !memcmp(frame, emu.ppu.color_buffer, sizeof(frame)));
+
+    // Restoring into a freshly booted emulator
+    emulator_t fresh;
+    create_emulator(&fresh, TEST_ROM);
+    mu_assert("Load fresh state", load_state_emulator(&fresh, state, size));
+    for (unsigned i = 0; i < 10; i++) {
+        run_frame_emulator(&fresh);
+    }
+    mu_assert("Fresh cycles", fresh.cpu.cycles == cycles);
+    mu_assert("Fresh RAM", !memcmp(ram, fresh.cpu_bus.memory, sizeof(ram)));
+
+    destroy_emulator(&fresh);
+    destroy_emulator(&emu);
+    free(state);
+    return 0;
+}
+
+static char *test_reject_state() {
+    emulator_t emu;
+    create_emulator(&emu, TEST_ROM);
+
+    unsigned long size = get_state_size_emulator(&emu);
+    unsigned char *state = malloc(size);
+    save_state_emulator(&emu, state, size);
+    mu_assert("Truncated state", !load_state_emulator(&emu, state, size - 1));
+
+    emulator_state_header_t *header = (emulator_state_header_t *)state;
+    header->version++;
+    mu_assert("Version mismatch", !load_state_emulator(&emu, state, size));
+    header->version--;
+    header->magic[0] = 0;
+    mu_assert("Bad magic", !load_state_emulator(&emu, state, size));
+
+    destroy_emulator(&emu);
+    free(state);
+    return 0;
+}
+
+static char *test_shared_rom() {
+    rom_t rom;
+    load_rom(&rom, TEST_ROM);
+
+    emulator_t a, b;
+    create_rom_emulator(&a, &rom);
+    create_rom_emulator(&b, &rom);
+    mu_assert("Shared image", a.rom.image == rom.image);
+    mu_assert("Shared image", b.rom.image == rom.image);
+    mu_assert("Image references", rom.image->references == 3);
+    mu_assert("Shared PRG ROM", get_prg_rom(&a.rom) == get_prg_rom(&b.rom));
+
+    // Cartridge RAM stays private to each instance
+    mu_assert("Private RAM", get_prg_ram(&a.rom) != get_prg_ram(&b.rom));
+    write_cpu_bus(&a.cpu_bus, CPU_MAP_RAM, 0x42);
+    mu_assert("Private RAM write", get_prg_ram(&a.rom)[0] == 0x42);
+    mu_assert("Private RAM write", get_prg_ram(&b.rom)[0] == 0);
+
+    // The image outlives the ROM it was loaded into
+    unload_rom(&rom);
+    mu_assert("Released reference", a.rom.image->references == 2);
+    for (unsigned i = 0; i < 5; i++) {
+        run_frame_emulator(&a);
+        run_frame_emulator(&b);
+    }
+    mu_assert("Shared run", a.cpu.cycles == b.cpu.cycles);
+
+    destroy_emulator(&a);
+    destroy_emulator(&b);
+    return 0;
+}
+
+static char *test_rom_image() {
+    rom_t rom;
+    load_rom(&rom, TEST_ROM);
+
+    // ROM data is used in place within the file contents
+    FILE *file = fopen(TEST_ROM, "rb");
+    unsigned char contents[ROM_HEADER_SIZE + 0x4000];
+    unsigned long size = fread(contents, 1, sizeof(contents), file);
+    fclose(file);
+    mu_assert("Read ROM file", size == sizeof(contents));
+    mu_assert("File size", rom.image->file.size >= size);
+    mu_assert("In-place image",
+              rom.image->data.buffer ==
+                  rom.image->file.buffer + ROM_HEADER_SIZE);
+    mu_assert("PRG ROM contents",
+              !memcmp(get_prg_rom(&rom),
+                      contents + ROM_HEADER_SIZE + rom.header.trainer_size,
+                      rom.header.prg_rom_size));
+
+    // Only cartridge RAM is allocated
+    unsigned long ram_size = rom.header.prg_ram_size + rom.header.chr_ram_size;
+    mu_assert("Cartridge RAM", rom.ram.size == ram_size);
+
+    unload_rom(&rom);
+    mu_assert("Unloaded", rom.image == NULL);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_save_load_state);
+    mu_run_test(test_shared_rom);
+    mu_run_test(test_rom_image);
+    mu_run_test(test_reject_state);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include <stdio.h>
+
+#include "./ctest.h"
+
+#include "../../src/pacer.h"
+
+int tests_run = 0;
+
+char message[1024] = {0};
+
+static unsigned run_pacer(pacer_t *pacer, double now, float fill) {
+    unsigned frames = 0;
+    while (is_due_pacer(pacer, now, fill)) {
+        frames++;
+    }
+    present_pacer(pacer);
+    return frames;
+}
+
+static char *test_clock_rate() {
+    pacer_t pacer;
+    create_pacer(&pacer, PACER_CLOCK, 0);
+    mu_assert("Frame rate", fabs(1 / pacer.period - 60.0988) < 1e-4);
+
+    // A 60 Hz display falls behind the NTSC rate, dropping about one frame
+    // every ten seconds
+    for (unsigned i = 0; i < 6000; i++) {
+        run_pacer(&pacer, i / 60.0, 0);
+    }
+    snprintf(message, sizeof(message), "Emulated (%lu)", pacer.frames);
+    mu_assert(message, pacer.frames == 6009);
+    mu_assert("Dropped", pacer.dropped == 9);
+    mu_assert("Duplicated", pacer.duplicated == 0);
+    return 0;
+}
+
+static char *test_clock_refresh() {
+    pacer_t pacer;
+    create_pacer(&pacer, PACER_CLOCK, 0);
+
+    // A 144 Hz display shows most frames two or three times
+    for (unsigned i = 0; i < 1440; i++) {
+        run_pacer(&pacer, i / 144.0, 0);
+    }
+    snprintf(message, sizeof(message), "Emulated (%lu)", pacer.frames);
+    mu_assert(message, pacer.frames == 601);
+    mu_assert("Dropped", pacer.dropped == 0);
+    mu_assert("Duplicated", pacer.duplicated == 1440 - 601);
+
+    // The wait ends at the next deadline
+    double now = 1439 / 144.0;
+    double wait = get_wait_pacer(&pacer, now);
+    mu_assert("Wait", wait > 0 && wait <= pacer.period);
+    mu_assert("Wait deadline", fabs(now + wait - pacer.deadline) < 1e-9);
+    return 0;
+}
+
+static char *test_clock_stall() {
+    pacer_t pacer;
+    create_pacer(&pacer, PACER_CLOCK, 0);
+    run_pacer(&pacer, 0, 0);
+
+    // A long stall only catches up a few frames before the schedule restarts
+    mu_assert("Catch up", run_pacer(&pacer, 1, 0) == PACER_MAX_FRAMES);
+    mu_assert("Stall dropped", pacer.dropped == PACER_MAX_FRAMES - 1);
+    mu_assert("Restarted", pacer.deadline > 1);
+    mu_assert("Resumed", run_pacer(&pacer, 1 + pacer.period, 0) == 1);
+    return 0;
+}
+
+static char *test_audio_fill() {
+    pacer_t pacer;
+    create_pacer(&pacer, PACER_AUDIO, 0);
+    mu_assert("Audio low", run_pacer(&pacer, 0, 0.25f) == PACER_MAX_FRAMES);
+    mu_assert("Audio full", run_pacer(&pacer, 0, 0.75f) == 0);
+    mu_assert("Audio duplicated", pacer.duplicated == 1);
+    mu_assert("Audio wait", get_wait_pacer(&pacer, 0) == PACER_POLL);
+
+    // Emulation stops as soon as the fill reaches its target
+    float fill = 0.2f;
+    unsigned frames = 0;
+    while (is_due_pacer(&pacer, 0, fill)) {
+        fill += 0.1f;
+        frames++;
+    }
+    mu_assert("Audio target", frames == 3);
+    return 0;
+}
+
+static char *test_vsync() {
+    pacer_t pacer;
+    create_pacer(&pacer, PACER_VSYNC, 0);
+    for (unsigned i = 0; i < 10; i++) {
+        mu_assert("One frame per refresh", run_pacer(&pacer, 0, 1) == 1);
+    }
+    mu_assert("Vsync wait", get_wait_pacer(&pacer, 0) == PACER_POLL);
+    mu_assert("Vsync counters", pacer.dropped == 0 && pacer.duplicated == 0);
+    return 0;
+}
+
+static char *test_parse_mode() {
+    pacer_mode_t mode;
+    mu_assert("Parse clock", parse_mode_pacer("clock", &mode));
+    mu_assert("Clock mode", mode == PACER_CLOCK);
+    mu_assert("Parse audio", parse_mode_pacer("audio", &mode));
+    mu_assert("Audio mode", mode == PACER_AUDIO);
+    mu_assert("Parse vsync", parse_mode_pacer("vsync", &mode));
+    mu_assert("Vsync mode", mode == PACER_VSYNC);
+    mu_assert("Parse invalid", !parse_mode_pacer("fast", &mode));
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_clock_rate);
+    mu_run_test(test_clock_refresh);
+    mu_run_test(test_clock_stall);
+    mu_run_test(test_audio_fill);
+    mu_run_test(test_vsync);
+    mu_run_test(test_parse_mode);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
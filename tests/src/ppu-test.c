@@ -75,8 +75,130 @@ static char *test_blargg_ppu_vbl_nmi() {
     return 0;
 }
 
+static bool past_cycles(emulator_t *emu, void *data) {
+    return emu->cpu.cycles >= *(unsigned long *)data;
+}
+
+static char *test_sprite_hit() {
+    const char *test_roms[11] = {
+        "../roms/sprite_hit_tests/01.basics.nes",
+        "../roms/sprite_hit_tests/02.alignment.nes",
+        "../roms/sprite_hit_tests/03.corners.nes",
+        "../roms/sprite_hit_tests/04.flip.nes",
+        "../roms/sprite_hit_tests/05.left_clip.nes",
+        "../roms/sprite_hit_tests/06.right_edge.nes",
+        "../roms/sprite_hit_tests/07.screen_bottom.nes",
+        "../roms/sprite_hit_tests/08.double_height.nes",
+        "../roms/sprite_hit_tests/09.timing_basics.nes",
+        "../roms/sprite_hit_tests/10.timing_order.nes",
+        "../roms/sprite_hit_tests/11.edge_timing.nes",
+    };
+
+    // Result codes left at $F8, 1 being a pass. The sprite pipeline has failed
+    // the rest since before the catch-up scheduler, so they pin its behavior
+    const unsigned char expected[11] = {1, 2, 2, 2, 2, 1, 3, 3, 3, 3, 2};
+
+    // About a hundred frames, long enough for every test to finish
+    const unsigned long CYCLES = 3000000;
+
+    static unsigned short frame[PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT];
+    for (unsigned i = 0; i < 11; i++) {
+        emulator_t emu;
+
+        // Lazy catch-up renders whole scanlines between register accesses
+        create_emulator(&emu, test_roms[i]);
+        mu_assert("Run lazily",
+                  run_cycles_emulator(&emu, CYCLES) == EMULATOR_CYCLES);
+        unsigned char result = read_cpu_bus(&emu.cpu_bus, 0xF8);
+        unsigned long cycles = emu.cpu.cycles;
+        memcpy(frame, emu.ppu.color_buffer, sizeof(frame));
+        destroy_emulator(&emu);
+
+        printf("SPRITE_HIT %s\n", test_roms[i]);
+        printf("Result: %02X\n", result);
+        mu_assert("SPRITE_HIT result changed", result == expected[i]);
+
+        // Syncing after every instruction steps the PPU dot by dot instead
+        create_emulator(&emu, test_roms[i]);
+        mu_assert("Run dot by dot",
+                  run_until_emulator(&emu, past_cycles, &cycles) ==
+                      EMULATOR_PREDICATE);
+        mu_assert("SPRITE_HIT cycles", emu.cpu.cycles == cycles);
+        mu_assert("SPRITE_HIT frame differs from the dot by dot render",
+                  memcmp(frame, emu.ppu.color_buffer, sizeof(frame)) == 0);
+        destroy_emulator(&emu);
+    }
+    return 0;
+}
+
+static bool in_vblank(emulator_t *emu, void *data) {
+    return emu->ppu.scanline == PPU_SCANLINE_VBLANK;
+}
+
+static bool on_scanline(emulator_t *emu, void *data) {
+    return emu->ppu.scanline == *(unsigned *)data;
+}
+
+static char *test_run_loops() {
+    emulator_t emu;
+    create_emulator(&emu, "../roms/ppu_vbl_nmi/01-vbl_basics.nes");
+
+    // Frames end on the scanline wrap, roughly 29781 CPU cycles apart
+    mu_assert("Run frame", run_frame_emulator(&emu) == EMULATOR_FRAME);
+    for (unsigned i = 0; i < 4; i++) {
+        unsigned long frames = emu.ppu.frames;
+        unsigned long cycles = emu.cpu.cycles;
+        mu_assert("Run frame", run_frame_emulator(&emu) == EMULATOR_FRAME);
+        mu_assert("Frame count", emu.ppu.frames == frames + 1);
+        mu_assert("Frame edge", emu.ppu.scanline == 0);
+
+        unsigned long delta = emu.cpu.cycles - cycles;
+        mu_assert("Frame length", delta > 29700 && delta < 29860);
+    }
+
+    unsigned long cycles = emu.cpu.cycles;
+    mu_assert("Run cycles",
+              run_cycles_emulator(&emu, 1000) == EMULATOR_CYCLES);
+    mu_assert("Cycle count",
+              emu.cpu.cycles >= cycles + 1000 &&
+                  emu.cpu.cycles < cycles + 1008);
+
+    mu_assert("Run until",
+              run_until_emulator(&emu, in_vblank, NULL) == EMULATOR_PREDICATE);
+    mu_assert("Predicate", emu.ppu.scanline == PPU_SCANLINE_VBLANK);
+    destroy_emulator(&emu);
+
+    // nestest idles without touching PPU registers once its menu is drawn, so
+    // a mid-frame scanline is only seen if the PPU catches up every check
+    create_emulator(&emu, "../roms/nestest/nestest.nes");
+    mu_assert("Idle frame", run_frame_emulator(&emu) == EMULATOR_FRAME);
+    for (unsigned i = 0; i < 4; i++) {
+        unsigned scanline = 100;
+        unsigned long frames = emu.ppu.frames;
+        mu_assert("Run until scanline",
+                  run_until_emulator(&emu, on_scanline, &scanline) ==
+                      EMULATOR_PREDICATE);
+        mu_assert("Scanline", emu.ppu.scanline == 100);
+        mu_assert("Same frame", emu.ppu.frames == frames);
+        mu_assert("Run to next frame",
+                  run_frame_emulator(&emu) == EMULATOR_FRAME);
+    }
+
+    // Cycle runs return with the PPU three dots per CPU cycle along
+    unsigned long dots = emu.ppu.cycles;
+    cycles = emu.cpu.cycles;
+    run_cycles_emulator(&emu, 1000);
+    mu_assert("Synced dots",
+              emu.ppu.cycles - dots == (emu.cpu.cycles - cycles) * 3);
+
+    destroy_emulator(&emu);
+    return 0;
+}
+
 static char *all_tests() {
     mu_run_test(test_blargg_ppu_vbl_nmi);
+    mu_run_test(test_sprite_hit);
+    mu_run_test(test_run_loops);
     return 0;
 }
 
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./ctest.h"
+
+#include "../../src/profile.h"
+
+int tests_run = 0;
+
+static char *test_regions() {
+    mu_assert("RAM", get_region_profile(0x0000) == PROFILE_REGION_RAM);
+    mu_assert("RAM mirror", get_region_profile(0x1fff) == PROFILE_REGION_RAM);
+    mu_assert("PPU", get_region_profile(0x2000) == PROFILE_REGION_PPU);
+    mu_assert("PPU mirror", get_region_profile(0x3fff) == PROFILE_REGION_PPU);
+    mu_assert("APU", get_region_profile(0x4000) == PROFILE_REGION_APU_IO);
+    mu_assert("IO", get_region_profile(0x4017) == PROFILE_REGION_APU_IO);
+    mu_assert("Mapper", get_region_profile(0x6000) == PROFILE_REGION_MAPPER);
+    mu_assert("Mapper", get_region_profile(0xffff) == PROFILE_REGION_MAPPER);
+    return 0;
+}
+
+static char *test_record_merge() {
+    profile_t a, b;
+    clear_profile(&a);
+    clear_profile(&b);
+
+    // LDA immediate and LDA absolute
+    record_op_profile(&a, 0xa9, 2);
+    record_op_profile(&a, 0xa9, 2);
+    record_op_profile(&b, 0xad, 4);
+    b.reads[PROFILE_REGION_RAM] = 3;
+    b.writes[PROFILE_REGION_PPU] = 1;
+    mu_assert("Op count", a.op_count[0xa9] == 2);
+    mu_assert("Op cycles", a.op_cycles[0xa9] == 4);
+    mu_assert("Mode count", a.mode_count[OP_TABLE[0xa9].address_mode] == 2);
+
+    merge_profile(&a, &b);
+    mu_assert("Merged op", a.op_count[0xad] == 1 && a.op_cycles[0xad] == 4);
+    mu_assert("Merged mode",
+              a.mode_cycles[OP_TABLE[0xad].address_mode] == 4);
+    mu_assert("Merged reads", a.reads[PROFILE_REGION_RAM] == 3);
+    mu_assert("Merged writes", a.writes[PROFILE_REGION_PPU] == 1);
+    return 0;
+}
+
+static char *test_print_order() {
+    profile_t profile;
+    clear_profile(&profile);
+    record_op_profile(&profile, 0xea, 2);
+    record_op_profile(&profile, 0x20, 6);
+
+    char output[0x4000] = {0};
+    FILE *file = tmpfile();
+    print_profile(&profile, file);
+    rewind(file);
+    fread(output, 1, sizeof(output) - 1, file);
+    fclose(file);
+
+    // Opcodes are sorted by cycles and unused opcodes are omitted
+    char *jsr = strstr(output, "$20 ");
+    char *nop = strstr(output, "$EA ");
+    mu_assert("JSR listed", jsr != NULL);
+    mu_assert("NOP listed", nop != NULL);
+    mu_assert("Sorted by cycles", jsr < nop);
+    mu_assert("Unused omitted", strstr(output, "$A9 ") == NULL);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_regions);
+    mu_run_test(test_record_merge);
+    mu_run_test(test_print_order);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
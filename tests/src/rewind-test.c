@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./ctest.h"
+
+#include "../../src/rewind.h"
+
+int tests_run = 0;
+
+static const char *TEST_ROM = "../roms/sprite_hit_tests/01.basics.nes";
+
+static char *test_delta() {
+    unsigned char prev[1000];
+    unsigned char next[1000];
+    unsigned char delta[2 * sizeof(prev) + 2 * REWIND_RECORD_HEADER];
+    for (unsigned i = 0; i < sizeof(prev); i++) {
+        prev[i] = i * 13;
+        next[i] = prev[i];
+    }
+
+    // Identical buffers encode to a single record
+    unsigned long size = encode_delta_rewind(prev, next, sizeof(prev), delta);
+    mu_assert("Empty delta", size == REWIND_RECORD_HEADER);
+
+    // Sparse and dense changes round trip in both directions
+    next[0] ^= 1;
+    next[500] ^= 0xff;
+    next[502] ^= 0x10;
+    for (unsigned i = 900; i < sizeof(next); i += 2) {
+        next[i] ^= i;
+    }
+    size = encode_delta_rewind(prev, next, sizeof(prev), delta);
+    mu_assert("Compressed delta", size < 200);
+
+    unsigned char state[sizeof(prev)];
+    memcpy(state, next, sizeof(state));
+    apply_delta_rewind(state, delta, size);
+    mu_assert("Delta to prev", !memcmp(state, prev, sizeof(state)));
+    apply_delta_rewind(state, delta, size);
+    mu_assert("Delta to next", !memcmp(state, next, sizeof(state)));
+
+    // Worst case alternating changes stay within the bound
+    for (unsigned i = 0; i < sizeof(next); i++) {
+        next[i] = prev[i] ^ (i & 1);
+    }
+    size = encode_delta_rewind(prev, next, sizeof(prev), delta);
+    mu_assert("Delta bound", size <= sizeof(delta));
+    memcpy(state, next, sizeof(state));
+    apply_delta_rewind(state, delta, size);
+    mu_assert("Alternating delta", !memcmp(state, prev, sizeof(state)));
+    return 0;
+}
+
+static char *test_step_back() {
+    emulator_t emu;
+    create_emulator(&emu, TEST_ROM);
+
+    rewind_t rewind;
+    create_rewind(&rewind, &emu, 2, 64, 1 << 20);
+    mu_assert("Empty rewind", !step_back_rewind(&rewind, &emu));
+
+    // Record the state at each snapshot
+    unsigned long cycles[16];
+    unsigned char ram[16][CPU_MAP_MIRROR_0];
+    for (unsigned i = 0; i < 32; i++) {
+        if (i % 2 == 0) {
+            cycles[i / 2] = emu.cpu.cycles;
+            memcpy(ram[i / 2], emu.cpu_bus.memory, CPU_MAP_MIRROR_0);
+        }
+        capture_rewind(&rewind, &emu);
+        run_frame_emulator(&emu);
+    }
+
+    // Walk back through every snapshot
+    for (int i = 14; i >= 0; i--) {
+        mu_assert("Step back", step_back_rewind(&rewind, &emu));
+        mu_assert("Rewound cycles", emu.cpu.cycles == cycles[i]);
+        mu_assert("Rewound RAM",
+                  !memcmp(ram[i], emu.cpu_bus.memory, CPU_MAP_MIRROR_0));
+    }
+    mu_assert("Oldest snapshot", !step_back_rewind(&rewind, &emu));
+
+    destroy_rewind(&rewind);
+    destroy_emulator(&emu);
+    return 0;
+}
+
+static char *test_budget() {
+    emulator_t emu;
+    create_emulator(&emu, TEST_ROM);
+
+    // Room for only a few deltas, so the oldest are evicted
+    rewind_t rewind;
+    create_rewind(&rewind, &emu, 1, 64, 2048);
+
+    unsigned long cycles[64];
+    for (unsigned i = 0; i < 64; i++) {
+        cycles[i] = emu.cpu.cycles;
+        capture_rewind(&rewind, &emu);
+        run_frame_emulator(&emu);
+    }
+
+    unsigned steps = 0;
+    while (step_back_rewind(&rewind, &emu)) {
+        steps++;
+        mu_assert("Budget cycles", emu.cpu.cycles == cycles[63 - steps]);
+    }
+    mu_assert("Budget evicted", steps > 0 && steps < 63);
+
+    destroy_rewind(&rewind);
+    destroy_emulator(&emu);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_delta);
+    mu_run_test(test_step_back);
+    mu_run_test(test_budget);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
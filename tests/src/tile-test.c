@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./ctest.h"
+
+#include "../../src/tile.h"
+
+int tests_run = 0;
+
+static char *test_decode_row() {
+    for (unsigned lo = 0; lo < 256; lo++) {
+        for (unsigned hi = 0; hi < 256; hi++) {
+            unsigned char attribute = (lo ^ hi) & 3;
+            unsigned char pixels[8];
+            decode_row_tile(lo, hi, attribute, pixels);
+
+            for (unsigned x = 0; x < 8; x++) {
+                unsigned char color =
+                    ((lo >> (7 - x)) & 1) | (((hi >> (7 - x)) & 1) << 1);
+                unsigned char expected = color ? (attribute << 2) | color : 0;
+                mu_assert("Decoded pixel", pixels[x] == expected);
+            }
+        }
+    }
+    return 0;
+}
+
+static char *test_decode_planes() {
+    unsigned char pixels[8];
+    decode_planes_tile(0xF0, 0xCC, 0xAA, 0x0F, pixels);
+
+    unsigned char expected[8] = {0x07, 0x03, 0x05, 0x01, 0x0E, 0x0A, 0, 0};
+    mu_assert("Decoded planes", memcmp(pixels, expected, 8) == 0);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_decode_row);
+    mu_run_test(test_decode_planes);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include "./ctest.h"
+
+#include "../../src/triple.h"
+
+int tests_run = 0;
+
+#define TRIPLE_TEST_SIZE   4096
+#define TRIPLE_TEST_FRAMES 20000
+
+static char *test_handover() {
+    triple_t triple;
+    create_triple(&triple, 4);
+    mu_assert("Initially stale", !is_fresh_triple(&triple));
+    mu_assert("Nothing to acquire", !acquire_triple(&triple));
+    mu_assert("No duplicate before a frame", triple.duplicated == 0);
+
+    // Front and back buffers never alias
+    get_back_triple(&triple)[0] = 1;
+    publish_triple(&triple);
+    mu_assert("Fresh", is_fresh_triple(&triple));
+    mu_assert("Distinct buffers",
+              get_back_triple(&triple) != get_front_triple(&triple));
+    mu_assert("Acquire", acquire_triple(&triple));
+    mu_assert("Frame 1", get_front_triple(&triple)[0] == 1);
+    mu_assert("Stale", !acquire_triple(&triple));
+    mu_assert("Duplicate", triple.duplicated == 1);
+
+    // Only the latest of several frames is acquired
+    get_back_triple(&triple)[0] = 2;
+    publish_triple(&triple);
+    get_back_triple(&triple)[0] = 3;
+    publish_triple(&triple);
+    mu_assert("Dropped", triple.dropped == 1);
+    mu_assert("Acquire latest", acquire_triple(&triple));
+    mu_assert("Frame 3", get_front_triple(&triple)[0] == 3);
+    mu_assert("Published", triple.published == 3);
+    mu_assert("Acquired", triple.acquired == 2);
+    destroy_triple(&triple);
+    return 0;
+}
+
+static void *produce_triple(void *data) {
+    triple_t *triple = (triple_t *)data;
+    for (unsigned frame = 1; frame <= TRIPLE_TEST_FRAMES; frame++) {
+        unsigned *words = (unsigned *)get_back_triple(triple);
+        for (unsigned i = 0; i < TRIPLE_TEST_SIZE / sizeof(unsigned); i++) {
+            words[i] = frame;
+        }
+        publish_triple(triple);
+        if (frame % 64 == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static char *test_concurrent() {
+    triple_t triple;
+    create_triple(&triple, TRIPLE_TEST_SIZE);
+    pthread_t producer;
+    pthread_create(&producer, NULL, produce_triple, &triple);
+
+    // Every acquired frame is complete and newer than the previous one
+    unsigned last = 0;
+    bool complete = true;
+    bool ordered = true;
+    while (last < TRIPLE_TEST_FRAMES) {
+        if (!acquire_triple(&triple)) {
+            sched_yield();
+            continue;
+        }
+        unsigned *words = (unsigned *)get_front_triple(&triple);
+        for (unsigned i = 0; i < TRIPLE_TEST_SIZE / sizeof(unsigned); i++) {
+            complete &= words[i] == words[0];
+        }
+        ordered &= words[0] > last;
+        last = words[0];
+    }
+    pthread_join(producer, NULL);
+
+    mu_assert("Complete frames", complete);
+    mu_assert("Ordered frames", ordered);
+    mu_assert("Frame accounting",
+              triple.acquired + triple.dropped == TRIPLE_TEST_FRAMES);
+    destroy_triple(&triple);
+    return 0;
+}
+
+static char *all_tests() {
+    mu_run_test(test_handover);
+    mu_run_test(test_concurrent);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *result = all_tests();
+    if (result != 0) {
+        printf("FAILED... %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Number of tests run: %d\n", tests_run);
+
+    return result != 0;
+}
\ No newline at end of file
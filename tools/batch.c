@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/batch.h"
+
+#define ARG_WORKERS "-j"
+
+void print_usage() {
+    printf("Usage: nesc-batch <manifest_file> [%s <workers>]\n", ARG_WORKERS);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2 && !(argc == 4 && strcmp(argv[2], ARG_WORKERS) == 0)) {
+        print_usage();
+        exit(1);
+    }
+    unsigned workers = argc == 4 ? strtoul(argv[3], NULL, 10) : 0;
+
+    // Load every cartridge once, then run the jobs across the host
+    batch_t batch;
+    load_manifest_batch(&batch, argv[1]);
+    run_batch(&batch, workers);
+    print_results_batch(&batch, stdout);
+
+    destroy_batch(&batch);
+    return 0;
+}
\ No newline at end of file
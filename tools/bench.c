@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "../src/emulator.h"
+
+#define ARG_FRAMES   "-f"
+#define ARG_ROM_DIR  "-r"
+#define ARG_JSON     "-o"
+#define BENCH_FRAMES 600
+
+// Maximum number of ROMs run by a workload
+#define BENCH_ROMS 16
+
+/**
+ * @brief A fixed set of ROMs, each run for a multiple of the frame count.
+ *
+ */
+typedef struct {
+    const char *name;
+    unsigned scale;
+    const char *roms[BENCH_ROMS];
+} workload_t;
+
+/**
+ * @brief Totals measured over a workload.
+ *
+ */
+typedef struct {
+    unsigned long frames;
+    unsigned long instructions;
+    unsigned long dots;
+    double seconds;
+} result_t;
+
+static const workload_t WORKLOADS[] = {
+    {"nestest", 1, {"nestest/nestest.nes"}},
+    {"sprite_hit_tests",
+     1,
+     {
+         "sprite_hit_tests/01.basics.nes",
+         "sprite_hit_tests/02.alignment.nes",
+         "sprite_hit_tests/03.corners.nes",
+         "sprite_hit_tests/04.flip.nes",
+         "sprite_hit_tests/05.left_clip.nes",
+         "sprite_hit_tests/06.right_edge.nes",
+         "sprite_hit_tests/07.screen_bottom.nes",
+         "sprite_hit_tests/08.double_height.nes",
+         "sprite_hit_tests/09.timing_basics.nes",
+         "sprite_hit_tests/10.timing_order.nes",
+         "sprite_hit_tests/11.edge_timing.nes",
+     }},
+
+    // Finishes within a few frames and then waits in a loop
+    {"idle_frames", 10, {"ppu_vbl_nmi/01-vbl_basics.nes"}},
+
+    // Polls $2002 and toggles $2000/$2001 around vblank constantly
+    {"ppu_registers",
+     1,
+     {
+         "ppu_vbl_nmi/02-vbl_set_time.nes",
+         "ppu_vbl_nmi/05-nmi_timing.nes",
+     }},
+};
+
+#define WORKLOAD_COUNT (sizeof(WORKLOADS) / sizeof(WORKLOADS[0]))
+
+#ifdef NESC_PROFILE
+// Counters of every workload, printed at exit
+profile_t bench_profile;
+#endif
+
+void print_usage() {
+    printf("Usage: nesc-bench [%s <frames>] [%s <rom_dir>] [%s <json_file>]\n",
+           ARG_FRAMES,
+           ARG_ROM_DIR,
+           ARG_JSON);
+}
+
+double get_time_bench() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+long get_peak_rss_bench() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+result_t run_workload_bench(const workload_t *workload,
+                            const char *rom_dir,
+                            unsigned long frames) {
+    result_t result = {0};
+    emulator_t *emu = (emulator_t *)malloc(sizeof(emulator_t));
+    if (emu == NULL) {
+        fprintf(stderr, "Error: Unable to allocate emulator\n");
+        exit(1);
+    }
+
+    for (unsigned i = 0; i < BENCH_ROMS && workload->roms[i]; i++) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", rom_dir, workload->roms[i]);
+        create_emulator(emu, path);
+
+        // Only the emulation itself is timed
+        unsigned long instructions = emu->cpu.instructions;
+        unsigned long dots = emu->ppu.cycles;
+        double start = get_time_bench();
+        for (unsigned long f = 0; f < frames * workload->scale; f++) {
+            if (run_frame_emulator(emu) == EMULATOR_HALT) {
+                fprintf(stderr, "Error: \"%s\" halted\n", path);
+                exit(1);
+            }
+            result.frames++;
+        }
+        result.seconds += get_time_bench() - start;
+        result.instructions += emu->cpu.instructions - instructions;
+        result.dots += emu->ppu.cycles - dots;
+#ifdef NESC_PROFILE
+        merge_profile(&bench_profile, &emu->cpu_bus.profile);
+#endif
+        destroy_emulator(emu);
+    }
+    free(emu);
+    return result;
+}
+
+void write_json_bench(FILE *file,
+                      result_t *results,
+                      unsigned long frames,
+                      long peak_rss_kb) {
+    // Peak RSS is a process-wide high-water mark, so it is only reported once
+    fprintf(file,
+            "{\n  \"frames\": %lu,\n  \"peak_rss_kb\": %ld,\n"
+            "  \"workloads\": [\n",
+            frames,
+            peak_rss_kb);
+    for (unsigned i = 0; i < WORKLOAD_COUNT; i++) {
+        result_t *result = &results[i];
+        fprintf(file,
+                "    {\"name\": \"%s\", \"frames\": %lu, "
+                "\"instructions\": %lu, \"dots\": %lu, \"seconds\": %.6f, "
+                "\"fps\": %.2f, \"ns_per_instruction\": %.3f, "
+                "\"ns_per_dot\": %.3f}%s\n",
+                WORKLOADS[i].name,
+                result->frames,
+                result->instructions,
+                result->dots,
+                result->seconds,
+                result->frames / result->seconds,
+                result->seconds * 1e9 / result->instructions,
+                result->seconds * 1e9 / result->dots,
+                i + 1 < WORKLOAD_COUNT ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+    unsigned long frames = BENCH_FRAMES;
+    const char *rom_dir = "tests/roms";
+    const char *json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], ARG_FRAMES) == 0) {
+            frames = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], ARG_ROM_DIR) == 0) {
+            rom_dir = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], ARG_JSON) == 0) {
+            json_path = argv[++i];
+        } else {
+            print_usage();
+            exit(1);
+        }
+    }
+    if (frames == 0) {
+        fprintf(stderr, "Error: Frame count must be positive\n");
+        exit(1);
+    }
+
+    result_t results[WORKLOAD_COUNT];
+    printf("%-18s %10s %12s %10s\n", "workload", "fps", "ns/instr", "ns/dot");
+    for (unsigned i = 0; i < WORKLOAD_COUNT; i++) {
+        result_t *result = &results[i];
+        *result = run_workload_bench(&WORKLOADS[i], rom_dir, frames);
+        printf("%-18s %10.1f %12.3f %10.3f\n",
+               WORKLOADS[i].name,
+               result->frames / result->seconds,
+               result->seconds * 1e9 / result->instructions,
+               result->seconds * 1e9 / result->dots);
+    }
+    long peak_rss_kb = get_peak_rss_bench();
+    printf("peak_rss_kb %ld\n", peak_rss_kb);
+
+    if (json_path) {
+        FILE *file = fopen(json_path, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Error: Could not open \"%s\"\n", json_path);
+            exit(1);
+        }
+        write_json_bench(file, results, frames, peak_rss_kb);
+        fclose(file);
+    }
+
+#ifdef NESC_PROFILE
+    print_profile(&bench_profile, stderr);
+#endif
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/trace.h"
+
+void print_usage() { printf("Usage: nesc-trace <trace_file>\n"); }
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        print_usage();
+        exit(1);
+    }
+
+    // Decode a binary trace into nestest.log lines
+    trace_t trace;
+    if (!load_trace(&trace, argv[1])) {
+        exit(1);
+    }
+    print_trace(&trace, stdout);
+
+    destroy_trace(&trace);
+    return 0;
+}
\ No newline at end of file